@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+package com.voiceskip.jni
+
+import android.content.Context
+import android.os.Build
+import android.util.Log
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import com.voiceskip.data.source.TranscriptionEvent
+import com.voiceskip.data.source.WhisperDataSourceImpl
+import com.voiceskip.media.FileAudioProvider
+import com.voiceskip.util.WakeLockManager
+import kotlinx.coroutines.CoroutineStart
+import kotlinx.coroutines.async
+import kotlinx.coroutines.coroutineScope
+import kotlinx.coroutines.flow.first
+import kotlinx.coroutines.runBlocking
+import kotlinx.coroutines.withTimeout
+import org.junit.After
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.util.zip.ZipFile
+
+private const val STARTUP_TAG = "StartupBenchmark"
+
+/**
+ * Time to the first segment from the app side, split in the phases the JVM can see.
+ * The library only loads once per process, so it is cold for the first run only; the
+ * native phases (backend init, model read, pipeline compile, first encode and decode)
+ * are split by startup_bench in lib/src/main/jni. The size of the native libraries is
+ * logged next to the library load, size_report breaks it down per symbol.
+ */
+@RunWith(AndroidJUnit4::class)
+class StartupBenchmark {
+
+    private lateinit var context: Context
+    private lateinit var wakeLockManager: WakeLockManager
+
+    @Before
+    fun setup() {
+        context = InstrumentationRegistry.getInstrumentation().targetContext
+        wakeLockManager = WakeLockManager(context)
+        wakeLockManager.acquire()
+    }
+
+    @After
+    fun teardown() {
+        wakeLockManager.release()
+    }
+
+    @Test
+    fun startup(): Unit = runBlocking {
+        val libraryStart = System.nanoTime()
+        Class.forName("com.voiceskip.whispercpp.whisper.WhisperContext", true, javaClass.classLoader)
+        val libraryMs = (System.nanoTime() - libraryStart) / 1_000_000
+        Log.i(STARTUP_TAG, "STARTUP: library=${libraryMs}ms | native=${nativeLibrariesKiB()}KiB")
+
+        for (modelPath in listOf(WhisperTestUtils.MODEL_BASE, WhisperTestUtils.MODEL_SMALL)) {
+            for (useGpu in listOf(false, true)) {
+                runStartup(modelPath, useGpu)
+            }
+        }
+    }
+
+    /** Uncompressed size of the native libraries the app ships for this device's ABI. */
+    private fun nativeLibrariesKiB(): Long {
+        val info = context.applicationInfo
+        val apks = listOf(info.sourceDir) + (info.splitSourceDirs ?: emptyArray())
+        for (abi in Build.SUPPORTED_ABIS) {
+            val bytes = apks.sumOf { apk ->
+                ZipFile(apk).use { zip ->
+                    zip.entries().asSequence()
+                        .filter { it.name.startsWith("lib/$abi/") && it.name.endsWith(".so") }
+                        .sumOf { it.size }
+                }
+            }
+            if (bytes > 0) return bytes / 1024
+        }
+        return 0
+    }
+
+    private suspend fun runStartup(modelPath: String, useGpu: Boolean) {
+        val modelName = modelPath.substringAfter("ggml-").substringBefore("-q")
+        val tempFile = WhisperTestUtils.copyAssetToCache(context, WhisperTestUtils.AUDIO_CLEAR)
+        val audioProvider = FileAudioProvider(file = tempFile)
+
+        val createStart = System.nanoTime()
+        val dataSource = WhisperDataSourceImpl()
+        val createMs = (System.nanoTime() - createStart) / 1_000_000
+
+        try {
+            val loadStart = System.nanoTime()
+            dataSource.loadModel(context.assets, modelPath, WhisperTestUtils.VAD_MODEL, useGpu)
+            val loaded = withTimeout(180_000) {
+                dataSource.events.first { it is TranscriptionEvent.ModelLoaded || it is TranscriptionEvent.Error }
+            }
+            val loadMs = (System.nanoTime() - loadStart) / 1_000_000
+            check(loaded is TranscriptionEvent.ModelLoaded) { "Load failed: $loaded" }
+
+            audioProvider.startDecoding()
+            dataSource.setDuration(audioProvider.durationMs.first { it > 0 })
+
+            val segmentStart = System.nanoTime()
+            val event = coroutineScope {
+                val firstSegment = async(start = CoroutineStart.UNDISPATCHED) {
+                    dataSource.events.first {
+                        it is TranscriptionEvent.Segment || it is TranscriptionEvent.StreamComplete
+                    }
+                }
+                dataSource.startStream(
+                    audioProvider = audioProvider,
+                    numThreads = if (useGpu) WhisperTestUtils.GPU_THREADS else WhisperTestUtils.CPU_THREADS,
+                    language = "en",
+                    translate = false
+                )
+                withTimeout(180_000) { firstSegment.await() }
+            }
+            val segmentMs = (System.nanoTime() - segmentStart) / 1_000_000
+            dataSource.stop()
+            check(event is TranscriptionEvent.Segment) { "No segment" }
+
+            val mode = if (loaded.gpuInfo != null) "GPU" else "CPU"
+            Log.i(STARTUP_TAG, "STARTUP: $modelName | $mode | create=${createMs}ms | load=${loadMs}ms" +
+                " | first_segment=${segmentMs}ms | total=${createMs + loadMs + segmentMs}ms")
+        } finally {
+            audioProvider.release()
+            tempFile.delete()
+            dataSource.destroy()
+        }
+    }
+}
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+package com.voiceskip.data
+
+/**
+ * Settings measured by the first-run calibration, see [com.voiceskip.domain.Autotuner].
+ *
+ * @param turboCpuThreads Threads of the CPU context in turbo mode
+ * @param gpuThreads Host threads of the GPU context
+ * @param liveMinChunkMs Minimum live chunk length, null for the native default
+ */
+data class DeviceTuning(
+    val turboCpuThreads: Int = UserPreferences.getTurboCpuThreads(),
+    val gpuThreads: Int = 1,
+    val liveMinChunkMs: Int? = null
+)
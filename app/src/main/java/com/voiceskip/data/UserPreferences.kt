@@ -5,6 +5,7 @@ package com.voiceskip.data
 import android.app.ActivityManager
 import android.content.Context
 import android.content.SharedPreferences
+import android.os.Build
 import androidx.datastore.core.DataStore
 import androidx.datastore.preferences.core.Preferences
 import androidx.datastore.preferences.core.booleanPreferencesKey
@@ -12,6 +13,7 @@ import androidx.datastore.preferences.core.edit
 import androidx.datastore.preferences.core.intPreferencesKey
 import androidx.datastore.preferences.core.stringPreferencesKey
 import androidx.datastore.preferences.preferencesDataStore
+import com.voiceskip.BuildConfig
 import kotlinx.coroutines.flow.Flow
 import kotlinx.coroutines.flow.map
 
@@ -33,7 +35,13 @@ class UserPreferences(private val context: Context) {
         private const val KEY_TURBO_LOAD_IN_PROGRESS = "turbo_load_in_progress"
         private val TURBO_MODE_KEY = booleanPreferencesKey("turbo_mode")
         private val TURBO_MODE_SET_KEY = booleanPreferencesKey("turbo_mode_set")
-        private const val MIN_RAM_GB_FOR_TURBO_AUTO = 6.0
+        private const val KEY_AUTOTUNE_IN_PROGRESS = "autotune_in_progress"
+        private val TUNING_KEY = stringPreferencesKey("tuning_key")
+        private val TUNED_TURBO_THREADS_KEY = intPreferencesKey("tuned_turbo_threads")
+        private val TUNED_GPU_THREADS_KEY = intPreferencesKey("tuned_gpu_threads")
+        private val TUNED_LIVE_CHUNK_KEY = intPreferencesKey("tuned_live_chunk_ms")
+        private const val MIN_RAM_GB_FOR_TURBO = 6.0
+        private const val MIN_CORES_FOR_TURBO = 4
 
         const val LANGUAGE_AUTO = "auto"
         const val LANGUAGE_ENGLISH = "en"
@@ -96,7 +104,7 @@ class UserPreferences(private val context: Context) {
             return (getMaxThreads() - 1).coerceAtLeast(1)
         }
 
-        fun hasEnoughCoresForTurbo(): Boolean = getMaxThreads() >= 8
+        fun hasEnoughCoresForTurbo(): Boolean = getMaxThreads() >= MIN_CORES_FOR_TURBO
 
         fun getTurboCpuThreads(): Int = (getMaxThreads() - 1).coerceAtMost(8)
 
@@ -107,8 +115,9 @@ class UserPreferences(private val context: Context) {
             return memoryInfo.totalMem / (1024.0 * 1024.0 * 1024.0)
         }
 
-        fun shouldAutoEnableTurbo(context: Context): Boolean =
-            hasEnoughCoresForTurbo() && getTotalMemoryGB(context) >= MIN_RAM_GB_FOR_TURBO_AUTO
+        /** Enough memory for two model copies and cores for two contexts, speed is calibrated */
+        fun isTurboViable(context: Context): Boolean =
+            hasEnoughCoresForTurbo() && getTotalMemoryGB(context) >= MIN_RAM_GB_FOR_TURBO
 
         fun getLanguageDisplayName(languageCode: String): String {
             return when (languageCode) {
@@ -201,6 +210,20 @@ class UserPreferences(private val context: Context) {
         preferences[DEFAULT_LANGUAGE_KEY] ?: LANGUAGE_AUTO
     }
 
+    val tuning: Flow<DeviceTuning> = context.dataStore.data.map { preferences ->
+        val defaults = DeviceTuning()
+        DeviceTuning(
+            turboCpuThreads = preferences[TUNED_TURBO_THREADS_KEY] ?: defaults.turboCpuThreads,
+            gpuThreads = preferences[TUNED_GPU_THREADS_KEY] ?: defaults.gpuThreads,
+            liveMinChunkMs = preferences[TUNED_LIVE_CHUNK_KEY]
+        )
+    }
+
+    /** Key of the last calibration, null if the app never calibrated */
+    val tuningKey: Flow<String?> = context.dataStore.data.map { preferences ->
+        preferences[TUNING_KEY]
+    }
+
     suspend fun setShowTimestamps(show: Boolean) {
         context.dataStore.edit { preferences ->
             preferences[SHOW_TIMESTAMPS_KEY] = show
@@ -267,5 +290,43 @@ class UserPreferences(private val context: Context) {
         return crashPrefs.getBoolean(KEY_TURBO_LOAD_IN_PROGRESS, false)
     }
 
-    fun shouldAutoEnableTurboForDevice(): Boolean = shouldAutoEnableTurbo(context)
+    fun setAutotuneInProgress(inProgress: Boolean) {
+        crashPrefs.edit().putBoolean(KEY_AUTOTUNE_IN_PROGRESS, inProgress).commit()
+    }
+
+    fun isAutotuneInProgress(): Boolean {
+        return crashPrefs.getBoolean(KEY_AUTOTUNE_IN_PROGRESS, false)
+    }
+
+    fun isTurboViableForDevice(): Boolean = isTurboViable(context)
+
+    /**
+     * Calibration results depend on the model, the device and its system image, which
+     * carries the GPU driver, and the app version, which carries the native library.
+     */
+    fun getTuningKey(modelPath: String): String = listOf(
+        Build.MANUFACTURER, Build.MODEL, Build.FINGERPRINT, BuildConfig.VERSION_CODE, modelPath
+    ).joinToString("|")
+
+    suspend fun setTuning(key: String, tuning: DeviceTuning) {
+        context.dataStore.edit { preferences ->
+            preferences[TUNING_KEY] = key
+            preferences[TUNED_TURBO_THREADS_KEY] = tuning.turboCpuThreads
+            preferences[TUNED_GPU_THREADS_KEY] = tuning.gpuThreads
+            if (tuning.liveMinChunkMs != null) {
+                preferences[TUNED_LIVE_CHUNK_KEY] = tuning.liveMinChunkMs
+            } else {
+                preferences.remove(TUNED_LIVE_CHUNK_KEY)
+            }
+        }
+    }
+
+    /** Applies a calibrated mode, setGpuEnabled() would reset the thread count */
+    suspend fun setCalibratedMode(gpuEnabled: Boolean, turbo: Boolean, numThreads: Int) {
+        context.dataStore.edit { preferences ->
+            preferences[GPU_ENABLED_KEY] = gpuEnabled
+            preferences[TURBO_MODE_KEY] = turbo
+            preferences[NUM_THREADS_KEY] = numThreads.coerceIn(1, getMaxThreads())
+        }
+    }
 }
@@ -2,6 +2,7 @@
 
 package com.voiceskip.data.repository
 
+import com.voiceskip.data.DeviceTuning
 import kotlinx.coroutines.flow.Flow
 
 data class UserSettings(
@@ -11,7 +12,8 @@ data class UserSettings(
     val gpuEnabled: Boolean,
     val turboModeEnabled: Boolean,
     val numThreads: Int,
-    val defaultLanguage: String
+    val defaultLanguage: String,
+    val tuning: DeviceTuning = DeviceTuning()
 )
 
 interface SettingsRepository {
@@ -25,8 +25,9 @@ class SettingsRepositoryImpl(
             PartialSettings(timestamps, translate, model, gpu, turbo)
         },
         userPreferences.numThreads,
-        userPreferences.defaultLanguage
-    ) { partial, threads, language ->
+        userPreferences.defaultLanguage,
+        userPreferences.tuning
+    ) { partial, threads, language, tuning ->
         UserSettings(
             showTimestamps = partial.showTimestamps,
             translateToEnglish = partial.translateToEnglish,
@@ -34,7 +35,8 @@ class SettingsRepositoryImpl(
             gpuEnabled = partial.gpuEnabled,
             turboModeEnabled = partial.turboModeEnabled,
             numThreads = threads,
-            defaultLanguage = language
+            defaultLanguage = language,
+            tuning = tuning
         )
     }
 
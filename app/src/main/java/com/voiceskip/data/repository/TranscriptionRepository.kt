@@ -37,6 +37,19 @@ interface TranscriptionRepository {
     suspend fun loadTurboModel(assets: AssetManager, modelPath: String, vadModelPath: String?): Result<Unit>
     suspend fun unloadTurboModel(): Result<Unit>
     fun isTurboModelLoaded(): Boolean
+
+    /**
+     * Transcribes [samples] on the loaded contexts without touching the transcription state.
+     * @return Elapsed milliseconds, failure on errors or after [timeoutMs]
+     */
+    suspend fun runCalibration(
+        samples: FloatArray,
+        numThreads: Int,
+        gpuThreads: Int,
+        minChunkMs: Int,
+        chunkExtendMs: Int,
+        timeoutMs: Long
+    ): Result<Long>
     suspend fun stopTranscription()
     fun getCurrentTranscriptionSource(): TranscriptionSource?
     fun setSessionLanguage(language: String?)
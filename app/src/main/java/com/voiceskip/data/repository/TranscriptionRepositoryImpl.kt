@@ -4,6 +4,7 @@ package com.voiceskip.data.repository
 
 import android.content.res.AssetManager
 import android.net.Uri
+import com.voiceskip.whispercpp.whisper.AudioProvider
 import com.voiceskip.whispercpp.whisper.WhisperSegment
 import com.voiceskip.data.ErrorHandler
 import com.voiceskip.data.UserPreferences
@@ -17,14 +18,18 @@ import com.voiceskip.util.VoiceSkipLogger
 import kotlinx.coroutines.CancellationException
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.CoroutineStart
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.async
 import kotlinx.coroutines.cancel
+import kotlinx.coroutines.coroutineScope
 import kotlinx.coroutines.flow.*
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
+import kotlinx.coroutines.withTimeoutOrNull
 import java.io.File
 import javax.inject.Inject
 import javax.inject.Singleton
@@ -94,10 +99,12 @@ class TranscriptionRepositoryImpl @Inject constructor(
             val languageCode = _sessionLanguage.value?.takeIf { it != UserPreferences.LANGUAGE_AUTO }
 
             liveTranscriptionUseCase.execute(
-                numThreads = getEffectiveThreadCount(settings.numThreads),
+                numThreads = getEffectiveThreadCount(settings),
                 language = languageCode,
                 translateToEnglish = settings.translateToEnglish,
-                gpuEnabled = settings.gpuEnabled
+                gpuEnabled = settings.gpuEnabled,
+                gpuThreads = settings.tuning.gpuThreads,
+                minChunkMs = settings.tuning.liveMinChunkMs
             ).collect { progress ->
                 when (progress) {
                     is LiveTranscriptionUseCase.Progress.Recording -> {
@@ -199,10 +206,11 @@ class TranscriptionRepositoryImpl @Inject constructor(
 
                 fileTranscriptionUseCase.execute(
                     source = source,
-                    numThreads = getEffectiveThreadCount(settings.numThreads),
+                    numThreads = getEffectiveThreadCount(settings),
                     language = languageCode,
                     translateToEnglish = settings.translateToEnglish,
-                    gpuEnabled = settings.gpuEnabled
+                    gpuEnabled = settings.gpuEnabled,
+                    gpuThreads = settings.tuning.gpuThreads
                 ).collect { progress ->
                     when (progress) {
                         is FileTranscriptionUseCase.Progress.Transcribing -> {
@@ -210,7 +218,10 @@ class TranscriptionRepositoryImpl @Inject constructor(
                                 progress = progress.progressPercent,
                                 currentSegment = progress.segments.lastOrNull()?.text,
                                 segments = progress.segments,
-                                detectedLanguage = progress.detectedLanguage
+                                detectedLanguage = progress.detectedLanguage,
+                                processedMs = progress.processedMs,
+                                etaMs = progress.etaMs,
+                                speed = progress.speed
                             )
                             _progress.value = progress.progressPercent
                         }
@@ -339,7 +350,9 @@ class TranscriptionRepositoryImpl @Inject constructor(
                         }
                     }
                     is TranscriptionEvent.Progress -> {
-                        _progress.value = event.percent
+                        if (event.percent >= 0) {
+                            _progress.value = event.percent
+                        }
                     }
                     is TranscriptionEvent.StreamComplete -> {
                         _progress.value = 100
@@ -387,8 +400,65 @@ class TranscriptionRepositoryImpl @Inject constructor(
 
     override fun isTurboModelLoaded(): Boolean = whisperDataSource.isTurboEnabled
 
-    private fun getEffectiveThreadCount(settingsThreads: Int): Int =
-        if (isTurboModelLoaded()) UserPreferences.getTurboCpuThreads() else settingsThreads
+    override suspend fun runCalibration(
+        samples: FloatArray,
+        numThreads: Int,
+        gpuThreads: Int,
+        minChunkMs: Int,
+        chunkExtendMs: Int,
+        timeoutMs: Long
+    ): Result<Long> = runCatching {
+        var position = 0
+        val audioProvider = object : AudioProvider {
+            override fun readAudio(buffer: FloatArray, maxSamples: Int): Int {
+                val count = minOf(maxSamples, samples.size - position)
+                if (count <= 0) return 0
+                samples.copyInto(buffer, 0, position, position + count)
+                position += count
+                return count
+            }
+        }
+
+        val startTime = System.currentTimeMillis()
+        val event = coroutineScope {
+            val done = async(start = CoroutineStart.UNDISPATCHED) {
+                whisperDataSource.events.first {
+                    it is TranscriptionEvent.StreamComplete || it is TranscriptionEvent.Error
+                }
+            }
+            whisperDataSource.startStream(
+                audioProvider = audioProvider,
+                numThreads = numThreads,
+                language = UserPreferences.LANGUAGE_ENGLISH,
+                translate = false,
+                gpuThreads = gpuThreads,
+                minChunkMs = minChunkMs,
+                chunkExtendMs = chunkExtendMs
+            )
+            withTimeoutOrNull(timeoutMs) { done.await() }.also {
+                if (it == null) {
+                    done.cancel()
+                    whisperDataSource.stop()
+                }
+            }
+        }
+        val elapsedMs = System.currentTimeMillis() - startTime
+
+        // The event collector picked up the calibration segments
+        updateInternalState { InternalTranscriptionState() }
+        _progress.value = 0
+
+        when (event) {
+            is TranscriptionEvent.StreamComplete ->
+                if (event.success) elapsedMs else error("Calibration stream failed")
+            is TranscriptionEvent.Error -> throw Exception(event.message)
+            null -> error("Calibration timed out after ${timeoutMs}ms")
+            else -> error("Unexpected event")
+        }
+    }
+
+    private fun getEffectiveThreadCount(settings: UserSettings): Int =
+        if (isTurboModelLoaded()) settings.tuning.turboCpuThreads else settings.numThreads
 
     private suspend fun updateInternalState(update: (InternalTranscriptionState) -> InternalTranscriptionState) {
         stateMutex.withLock {
@@ -25,11 +25,15 @@ sealed interface TranscriptionState {
         val stopReason: LiveTranscriptionUseCase.StopReason? = null
     ) : TranscriptionState
 
+    /** etaMs is -1 and speed 0 until the engine has measured its throughput */
     data class Transcribing(
         val progress: Int,
         val currentSegment: String?,
         val segments: List<WhisperSegment>,
-        val detectedLanguage: String? = null
+        val detectedLanguage: String? = null,
+        val processedMs: Long = 0,
+        val etaMs: Long = -1,
+        val speed: Float = 0f
     ) : TranscriptionState
 
     data class Complete(
@@ -10,7 +10,13 @@ import kotlinx.coroutines.flow.SharedFlow
 sealed class TranscriptionEvent {
     data class ModelLoaded(val gpuInfo: String?, val turbo: Boolean = false) : TranscriptionEvent()
     data class Segment(val segment: WhisperSegment, val language: String?) : TranscriptionEvent()
-    data class Progress(val percent: Int) : TranscriptionEvent()
+    /** percent and etaMs are -1 when the duration is unknown */
+    data class Progress(
+        val percent: Int,
+        val processedMs: Long = 0,
+        val etaMs: Long = -1,
+        val speed: Float = 0f
+    ) : TranscriptionEvent()
     data class StreamComplete(val success: Boolean) : TranscriptionEvent()
     data class Error(val message: String) : TranscriptionEvent()
 }
@@ -30,7 +36,10 @@ interface WhisperDataSource {
         numThreads: Int,
         language: String?,
         translate: Boolean,
-        live: Boolean = false
+        live: Boolean = false,
+        gpuThreads: Int = 1,
+        minChunkMs: Int? = null,
+        chunkExtendMs: Int? = null
     )
 
     fun stop()
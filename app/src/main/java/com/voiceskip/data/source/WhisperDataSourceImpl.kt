@@ -24,7 +24,13 @@ class WhisperDataSourceImpl : WhisperDataSource {
     override val events: SharedFlow<TranscriptionEvent> = _events.asSharedFlow()
 
     private val whisperContext: WhisperContext = WhisperContext.create(
-        onProgress = { progress -> scope.launch { _events.emit(TranscriptionEvent.Progress(progress)) } },
+        onProgress = { progress ->
+            scope.launch {
+                _events.emit(TranscriptionEvent.Progress(
+                    progress.percent, progress.processedMs, progress.etaMs, progress.speed
+                ))
+            }
+        },
         onLoaded = { slotIndex, gpuInfo ->
             val isTurbo = slotIndex == 1
             scope.launch { _events.emit(TranscriptionEvent.ModelLoaded(gpuInfo, turbo = isTurbo)) }
@@ -71,14 +77,20 @@ class WhisperDataSourceImpl : WhisperDataSource {
         numThreads: Int,
         language: String?,
         translate: Boolean,
-        live: Boolean
+        live: Boolean,
+        gpuThreads: Int,
+        minChunkMs: Int?,
+        chunkExtendMs: Int?
     ) {
         whisperContext.startStream(
             audioProvider = audioProvider,
             numThreads = numThreads,
             language = language,
             translate = translate,
-            live = live
+            live = live,
+            gpuThreads = gpuThreads,
+            minChunkMs = minChunkMs,
+            chunkExtendMs = chunkExtendMs
         )
     }
 
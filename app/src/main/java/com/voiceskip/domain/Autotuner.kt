@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+package com.voiceskip.domain
+
+import kotlin.math.ceil
+import kotlin.random.Random
+
+/**
+ * Candidate selection and scoring of the first-run calibration. Running the
+ * candidates is up to [ModelManager], this object holds no state.
+ */
+object Autotuner {
+    enum class Mode { CPU, GPU, TURBO }
+
+    /**
+     * @param numThreads Threads of the CPU context, the second context in turbo mode
+     * @param gpuThreads Host threads of the GPU context, unused in CPU mode
+     */
+    data class Candidate(val mode: Mode, val numThreads: Int, val gpuThreads: Int = 1) {
+        val totalThreads: Int
+            get() = when (mode) {
+                Mode.CPU -> numThreads
+                Mode.GPU -> gpuThreads
+                Mode.TURBO -> numThreads + gpuThreads
+            }
+    }
+
+    data class Measurement(val candidate: Candidate, val elapsedMs: Long)
+
+    /** Long enough for several chunks, short enough to keep the first start tolerable */
+    const val WORKLOAD_MS = 20_000
+    /** Short chunks so that turbo mode keeps both contexts busy */
+    const val CALIBRATION_CHUNK_MS = 5_000
+    const val CALIBRATION_CHUNKS = WORKLOAD_MS / CALIBRATION_CHUNK_MS
+    const val CANDIDATE_TIMEOUT_MS = 60_000L
+
+    /** Candidates within this of the fastest count as equal, fewer threads win */
+    const val TIE_TOLERANCE = 0.03
+    /** Share of the real time that live transcription may spend decoding */
+    const val LIVE_HEADROOM = 0.5
+    const val MIN_LIVE_CHUNK_MS = 5_000
+    const val MAX_LIVE_CHUNK_MS = 30_000
+
+    private const val SAMPLE_RATE = 16000
+    private const val WORKLOAD_SEED = 0x5EED
+
+    /**
+     * Turbo candidates run with one GPU host thread, [withGpuThreads] replaces it
+     * with the count of the fastest GPU candidate once that is known.
+     *
+     * @param highPerfThreads Number of big cores
+     * @param gpu GPU enabled by the user and the GPU context loaded, GPU and turbo
+     * candidates are worth running
+     */
+    fun candidates(maxThreads: Int, highPerfThreads: Int, gpu: Boolean, turboViable: Boolean): List<Candidate> {
+        val cpuThreads = listOf(highPerfThreads, maxThreads - 1)
+            .map { it.coerceIn(1, maxThreads) }
+            .distinct()
+        val result = cpuThreads.map { Candidate(Mode.CPU, it) }.toMutableList()
+        if (gpu) {
+            // The host threads run the ops the GPU backend lacks and the decoder sampling
+            result += listOf(1, 2, highPerfThreads)
+                .map { it.coerceIn(1, maxThreads) }
+                .distinct()
+                .map { Candidate(Mode.GPU, numThreads = 1, gpuThreads = it) }
+            if (turboViable) {
+                result += listOf(highPerfThreads, (maxThreads - 1).coerceAtMost(8))
+                    .map { it.coerceIn(1, maxThreads) }
+                    .distinct()
+                    .map { Candidate(Mode.TURBO, it, gpuThreads = 1) }
+            }
+        }
+        return result
+    }
+
+    /** Turbo candidates with the GPU host threads of the fastest GPU measurement */
+    fun withGpuThreads(candidates: List<Candidate>, measurements: List<Measurement>): List<Candidate> {
+        val gpuThreads = pick(measurements.filter { it.candidate.mode == Mode.GPU })
+            ?.candidate?.gpuThreads ?: return candidates
+        return candidates
+            .map { if (it.mode == Mode.TURBO) it.copy(gpuThreads = gpuThreads) else it }
+            .distinct()
+    }
+
+    /**
+     * The app bundles no speech, low level noise costs the same per chunk since
+     * the encoder always runs on a full window. Seeded to keep runs comparable.
+     */
+    fun workload(): FloatArray {
+        val random = Random(WORKLOAD_SEED)
+        return FloatArray(WORKLOAD_MS / 1000 * SAMPLE_RATE) { (random.nextFloat() - 0.5f) * 0.02f }
+    }
+
+    /** Fastest measurement, preferring fewer threads among near ties; null if none finished */
+    fun pick(measurements: List<Measurement>): Measurement? {
+        val fastest = measurements.minOfOrNull { it.elapsedMs } ?: return null
+        val limit = fastest * (1 + TIE_TOLERANCE)
+        return measurements
+            .filter { it.elapsedMs <= limit }
+            .minWith(compareBy<Measurement> { it.candidate.totalThreads }.thenBy { it.elapsedMs })
+    }
+
+    /**
+     * A live chunk has to be transcribed before the next one is recorded. Chunks cost
+     * about the same regardless of their length, so the chunk must be long enough to
+     * cover that cost with headroom. Parallel contexts are already in the elapsed time.
+     */
+    fun liveMinChunkMs(measurement: Measurement): Int {
+        val perChunkMs = measurement.elapsedMs.toDouble() / CALIBRATION_CHUNKS
+        val seconds = ceil(perChunkMs / LIVE_HEADROOM / 1000).toInt()
+        return (seconds * 1000).coerceIn(MIN_LIVE_CHUNK_MS, MAX_LIVE_CHUNK_MS)
+    }
+}
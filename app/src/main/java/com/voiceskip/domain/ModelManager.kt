@@ -4,11 +4,13 @@ package com.voiceskip.domain
 
 import android.content.res.AssetManager
 import android.util.Log
+import com.voiceskip.data.DeviceTuning
 import com.voiceskip.data.ErrorHandler
 import com.voiceskip.data.UserPreferences
 import com.voiceskip.data.repository.TranscriptionRepository
 import com.voiceskip.ui.main.FileManager
 import com.voiceskip.util.VoiceSkipLogger
+import com.voiceskip.whispercpp.whisper.WhisperCpuConfig
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.FlowPreview
 import kotlinx.coroutines.flow.Flow
@@ -83,6 +85,19 @@ class ModelManager(
                 _turboFallbackReason.value = TurboFallbackReason.CRASH
             }
 
+            // A user who turned the GPU off never has it loaded, not even to calibrate
+            var allowGpuCalibration = gpuEnabled
+            if (userPreferences.isAutotuneInProgress()) {
+                VoiceSkipLogger.w("Previous calibration crashed, calibrating on CPU only")
+                userPreferences.setAutotuneInProgress(false)
+                if (gpuEnabled) {
+                    userPreferences.setGpuEnabled(false)
+                    gpuEnabled = false
+                    _gpuFallbackReason.value = GpuFallbackReason.CRASH
+                }
+                allowGpuCalibration = false
+            }
+
             val currentState = _modelState.value
 
             if (!forceReload) {
@@ -105,25 +120,18 @@ class ModelManager(
 
             _modelState.value = ModelState.Loading(modelPath, gpuEnabled)
 
-            if (gpuEnabled) {
-                userPreferences.setGpuInProgress(true)
-            }
-
             fileManager.copyAssets(assets)
 
             val vadModelPath = userPreferences.getVadModelPath()
             VoiceSkipLogger.i("Loading model: $modelPath, vadModel: $vadModelPath, GPU: ${if (gpuEnabled) "enabled" else "disabled"}, forceReload: $forceReload")
 
-            val result = repository.loadModel(assets, modelPath, vadModelPath, gpuEnabled, forceReload)
-            val gpuInfo = result.getOrElse { e ->
-                Log.w(LOG_TAG, e)
-                VoiceSkipLogger.e("Failed to load model", e)
-                _modelState.value = ModelState.Error(e)
-                throw e
-            }
+            var gpuInfo = loadContext(assets, modelPath, vadModelPath, gpuEnabled, forceReload)
 
-            if (gpuEnabled) {
-                userPreferences.setGpuInProgress(false)
+            val calibrated = maybeAutotune(assets, modelPath, vadModelPath, allowGpuCalibration)
+            if (calibrated) {
+                gpuEnabled = userPreferences.gpuEnabled.first()
+                VoiceSkipLogger.i("Reloading model after calibration, GPU: ${if (gpuEnabled) "enabled" else "disabled"}")
+                gpuInfo = loadContext(assets, modelPath, vadModelPath, gpuEnabled, forceReload = true)
             }
 
             if (gpuEnabled && gpuInfo == null) {
@@ -133,20 +141,20 @@ class ModelManager(
             }
             _modelState.value = ModelState.Loaded(modelPath, gpuInfo)
 
-            if (repository.isTurboModelLoaded()) {
+            val calibratedTurbo = calibrated && gpuInfo != null && userPreferences.turboModeEnabled.first()
+            if (repository.isTurboModelLoaded() || calibratedTurbo) {
                 VoiceSkipLogger.i("Reloading turbo CPU model: $modelPath")
                 userPreferences.setTurboLoadInProgress(true)
                 repository.loadTurboModel(assets, modelPath, vadModelPath)
                 userPreferences.setTurboLoadInProgress(false)
             }
 
-            maybeAutoEnableTurbo(assets, modelPath, vadModelPath, gpuInfo)
-
             VoiceSkipLogger.d("Model state updated to: Loaded(path=$modelPath, gpu=$gpuInfo)")
         }.fold(
             onSuccess = { Result.success(Unit) },
             onFailure = { exception ->
                 userPreferences.setGpuInProgress(false)
+                userPreferences.setAutotuneInProgress(false)
                 val whisperError = ErrorHandler.handleError(exception)
                 ErrorHandler.logError(LOG_TAG, whisperError, critical = false)
                 VoiceSkipLogger.e("Failed to initialize model loading", whisperError)
@@ -156,6 +164,32 @@ class ModelManager(
         )
     }
 
+    /** Loads the main context, the GPU crash flag covers the load and the driver */
+    private suspend fun loadContext(
+        assets: AssetManager,
+        modelPath: String,
+        vadModelPath: String?,
+        useGpu: Boolean,
+        forceReload: Boolean
+    ): String? {
+        if (useGpu) {
+            userPreferences.setGpuInProgress(true)
+        }
+
+        val result = repository.loadModel(assets, modelPath, vadModelPath, useGpu, forceReload)
+        val gpuInfo = result.getOrElse { e ->
+            Log.w(LOG_TAG, e)
+            VoiceSkipLogger.e("Failed to load model", e)
+            _modelState.value = ModelState.Error(e)
+            throw e
+        }
+
+        if (useGpu) {
+            userPreferences.setGpuInProgress(false)
+        }
+        return gpuInfo
+    }
+
     fun isModelLoaded(): Boolean = _modelState.value is ModelState.Loaded
 
     suspend fun updateTurboMode(assets: AssetManager, enabled: Boolean): Result<Unit> {
@@ -195,21 +229,124 @@ class ModelManager(
 
     fun isTurboCpuLoaded(): Boolean = repository.isTurboModelLoaded()
 
-    private suspend fun maybeAutoEnableTurbo(assets: AssetManager, modelPath: String, vadModelPath: String?, gpuInfo: String?) {
-        if (userPreferences.turboModeHasBeenSet.first()) return
+    /**
+     * Calibrates once per device, system image, app version and model. Only the first
+     * calibration picks the mode, and only if the user never chose turbo mode; later ones
+     * refresh the thread counts and the live chunk length for the mode in use.
+     * Leaves the contexts in an undefined state, returns true if the caller must reload.
+     */
+    private suspend fun maybeAutotune(
+        assets: AssetManager,
+        modelPath: String,
+        vadModelPath: String?,
+        allowGpu: Boolean
+    ): Boolean {
+        val key = userPreferences.getTuningKey(modelPath)
+        val previousKey = userPreferences.tuningKey.first()
+        if (previousKey == key) return false
+
+        val applyMode = previousKey == null && !userPreferences.turboModeHasBeenSet.first()
+        val candidates = Autotuner.candidates(
+            maxThreads = UserPreferences.getMaxThreads(),
+            highPerfThreads = WhisperCpuConfig.preferredThreadCount,
+            gpu = allowGpu,
+            turboViable = userPreferences.isTurboViableForDevice()
+        )
+        VoiceSkipLogger.i("Calibrating $modelPath, ${candidates.size} candidates, first run: ${previousKey == null}")
+
+        val measurements = runCalibration(assets, modelPath, vadModelPath, candidates)
 
-        val gpuActive = gpuInfo != null
-        if (!gpuActive) return
+        val best = Autotuner.pick(measurements)
+        val mode = when {
+            applyMode && best != null -> best.candidate.mode
+            !userPreferences.gpuEnabled.first() -> Autotuner.Mode.CPU
+            userPreferences.turboModeEnabled.first() -> Autotuner.Mode.TURBO
+            else -> Autotuner.Mode.GPU
+        }
+        fun bestOf(mode: Autotuner.Mode) = Autotuner.pick(measurements.filter { it.candidate.mode == mode })
+
+        val defaults = DeviceTuning()
+        val tuning = DeviceTuning(
+            turboCpuThreads = bestOf(Autotuner.Mode.TURBO)?.candidate?.numThreads ?: defaults.turboCpuThreads,
+            gpuThreads = bestOf(mode.takeIf { it != Autotuner.Mode.CPU } ?: Autotuner.Mode.GPU)
+                ?.candidate?.gpuThreads ?: defaults.gpuThreads,
+            liveMinChunkMs = bestOf(mode)?.let { Autotuner.liveMinChunkMs(it) }
+        )
+        VoiceSkipLogger.i("Calibration picked $mode (best ${best?.candidate}), $tuning")
 
-        if (!userPreferences.shouldAutoEnableTurboForDevice()) return
+        userPreferences.setTuning(key, tuning)
+        if (applyMode && best != null) {
+            val numThreads = if (mode == Autotuner.Mode.CPU) {
+                best.candidate.numThreads
+            } else {
+                UserPreferences.getDefaultNumThreads(gpuEnabled = true)
+            }
+            userPreferences.setCalibratedMode(
+                gpuEnabled = mode != Autotuner.Mode.CPU,
+                turbo = mode == Autotuner.Mode.TURBO,
+                numThreads = numThreads
+            )
+        }
+        return true
+    }
 
-        VoiceSkipLogger.i("Auto-enabling turbo mode (first run, high-spec device)")
-        userPreferences.setTurboModeEnabled(true, isUserAction = false)
+    /** Runs what can be loaded, a failed load or candidate only drops its measurements */
+    private suspend fun runCalibration(
+        assets: AssetManager,
+        modelPath: String,
+        vadModelPath: String?,
+        candidates: List<Autotuner.Candidate>
+    ): List<Autotuner.Measurement> {
+        val samples = Autotuner.workload()
+        val measurements = mutableListOf<Autotuner.Measurement>()
+
+        suspend fun measure(mode: Autotuner.Mode) {
+            Autotuner.withGpuThreads(candidates, measurements).filter { it.mode == mode }.forEach { candidate ->
+                repository.runCalibration(
+                    samples = samples,
+                    numThreads = candidate.numThreads,
+                    gpuThreads = candidate.gpuThreads,
+                    minChunkMs = Autotuner.CALIBRATION_CHUNK_MS,
+                    chunkExtendMs = 0,
+                    timeoutMs = Autotuner.CANDIDATE_TIMEOUT_MS
+                ).onSuccess { elapsedMs ->
+                    VoiceSkipLogger.i("Calibration $candidate: ${elapsedMs}ms")
+                    measurements += Autotuner.Measurement(candidate, elapsedMs)
+                }.onFailure { e ->
+                    VoiceSkipLogger.w("Calibration $candidate failed: ${e.message}")
+                }
+            }
+        }
+
+        // A crash in here disables the GPU on the next start, see loadModel()
+        userPreferences.setAutotuneInProgress(true)
+        try {
+            if (repository.isTurboModelLoaded()) {
+                repository.unloadTurboModel()
+            }
 
-        userPreferences.setTurboLoadInProgress(true)
-        repository.loadTurboModel(assets, modelPath, vadModelPath)
-        userPreferences.setTurboLoadInProgress(false)
-        VoiceSkipLogger.i("Turbo mode auto-enabled and CPU model loaded")
+            repository.loadModel(assets, modelPath, vadModelPath, useGpu = false, forceReload = true)
+                .onSuccess { measure(Autotuner.Mode.CPU) }
+
+            if (candidates.any { it.mode != Autotuner.Mode.CPU }) {
+                // Null on blocklisted drivers: their GPU is never calibrated
+                val gpuInfo = repository.loadModel(
+                    assets, modelPath, vadModelPath, useGpu = true, forceReload = true
+                ).getOrNull()
+                if (gpuInfo != null) {
+                    measure(Autotuner.Mode.GPU)
+                    val gpuWorks = measurements.any { it.candidate.mode == Autotuner.Mode.GPU }
+                    if (gpuWorks && candidates.any { it.mode == Autotuner.Mode.TURBO }) {
+                        repository.loadTurboModel(assets, modelPath, vadModelPath)
+                            .onSuccess { measure(Autotuner.Mode.TURBO) }
+                        repository.unloadTurboModel()
+                    }
+                }
+            }
+        } finally {
+            userPreferences.setAutotuneInProgress(false)
+        }
+        return measurements
     }
 
     @OptIn(FlowPreview::class)
@@ -26,7 +26,10 @@ class FileTranscriptionUseCase @Inject constructor(
         data class Transcribing(
             val progressPercent: Int,
             val segments: List<WhisperSegment>,
-            val detectedLanguage: String?
+            val detectedLanguage: String?,
+            val processedMs: Long = 0,
+            val etaMs: Long = -1,
+            val speed: Float = 0f
         ) : Progress
 
         data class Complete(
@@ -53,11 +56,13 @@ class FileTranscriptionUseCase @Inject constructor(
         numThreads: Int,
         language: String?,
         translateToEnglish: Boolean,
-        gpuEnabled: Boolean
+        gpuEnabled: Boolean,
+        gpuThreads: Int = 1
     ): Flow<Progress> = channelFlow {
         val startTime = System.currentTimeMillis()
         var currentSegments = listOf<WhisperSegment>()
         var detectedLanguage: String? = null
+        var lastProgress = TranscriptionEvent.Progress(percent = 0)
 
         val audioProvider = when (source) {
             is Source.FromFile -> FileAudioProvider(file = source.file)
@@ -90,15 +95,24 @@ class FileTranscriptionUseCase @Inject constructor(
                             trySend(Progress.Transcribing(
                                 progressPercent = progress,
                                 segments = currentSegments,
-                                detectedLanguage = detectedLanguage
+                                detectedLanguage = detectedLanguage,
+                                processedMs = lastProgress.processedMs,
+                                etaMs = lastProgress.etaMs,
+                                speed = lastProgress.speed
                             ))
                         }
                         is TranscriptionEvent.Progress -> {
-                            trySend(Progress.Transcribing(
-                                progressPercent = event.percent,
-                                segments = currentSegments,
-                                detectedLanguage = detectedLanguage
-                            ))
+                            lastProgress = event
+                            if (event.percent >= 0) {
+                                trySend(Progress.Transcribing(
+                                    progressPercent = event.percent,
+                                    segments = currentSegments,
+                                    detectedLanguage = detectedLanguage,
+                                    processedMs = event.processedMs,
+                                    etaMs = event.etaMs,
+                                    speed = event.speed
+                                ))
+                            }
                         }
                         is TranscriptionEvent.StreamComplete -> {
                             if (event.success) {
@@ -132,7 +146,8 @@ class FileTranscriptionUseCase @Inject constructor(
                 numThreads = numThreads,
                 language = language,
                 translate = translateToEnglish,
-                live = false
+                live = false,
+                gpuThreads = gpuThreads
             )
 
             eventJob.join()
@@ -70,7 +70,9 @@ class LiveTranscriptionUseCase @Inject constructor(
         numThreads: Int,
         language: String?,
         translateToEnglish: Boolean,
-        gpuEnabled: Boolean
+        gpuEnabled: Boolean,
+        gpuThreads: Int = 1,
+        minChunkMs: Int? = null
     ): Flow<Progress> = channelFlow {
         val startTime = System.currentTimeMillis()
         val state = LiveState()
@@ -162,7 +164,9 @@ class LiveTranscriptionUseCase @Inject constructor(
                 numThreads = numThreads,
                 language = language,
                 translate = translateToEnglish,
-                live = true
+                live = true,
+                gpuThreads = gpuThreads,
+                minChunkMs = minChunkMs
             )
 
             eventJob.join()
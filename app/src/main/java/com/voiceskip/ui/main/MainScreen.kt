@@ -228,6 +228,8 @@ private fun MainScreenContent(
                 is TranscriptionUiState.Transcribing -> {
                     TranscribingScreen(
                         progress = uiState.transcriptionProgress,
+                        etaMs = uiState.transcriptionEtaMs,
+                        speed = uiState.transcriptionSpeed,
                         segments = uiState.transcriptionSegments,
                         showTimestamps = uiState.showTimestamps,
                         isComplete = false,
@@ -482,6 +484,8 @@ private fun ActionCard(
 @Composable
 private fun TranscribingScreen(
     progress: Int,
+    etaMs: Long = -1,
+    speed: Float = 0f,
     segments: List<com.voiceskip.whispercpp.whisper.WhisperSegment>,
     showTimestamps: Boolean,
     isComplete: Boolean,
@@ -532,6 +536,17 @@ private fun TranscribingScreen(
                                 fontWeight = FontWeight.Bold,
                                 color = MaterialTheme.colorScheme.onPrimaryContainer
                             )
+                            if (etaMs >= 0 && speed > 0f) {
+                                Text(
+                                    text = stringResource(
+                                        R.string.state_transcribing_eta,
+                                        formatDuration(etaMs),
+                                        speed
+                                    ),
+                                    style = MaterialTheme.typography.bodySmall,
+                                    color = MaterialTheme.colorScheme.onPrimaryContainer
+                                )
+                            }
                             if (onLanguageChange != null) {
                                 LanguageDropdown(
                                     currentLanguage = currentLanguage,
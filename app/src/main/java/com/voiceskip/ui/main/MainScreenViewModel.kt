@@ -104,6 +104,10 @@ data class MainScreenUiState(
     val transcriptionResult: TranscriptionResult? = null,
     val transcriptionSegments: List<WhisperSegment> = emptyList(),
     val transcriptionProgress: Int = 0,
+    /** Remaining time of a file transcription, -1 while unknown */
+    val transcriptionEtaMs: Long = -1,
+    /** Seconds of audio transcribed per second, 0 while unknown */
+    val transcriptionSpeed: Float = 0f,
     val detectedLanguage: String? = null,
     val canTranscribe: Boolean = false,
     val hasSavedTranscription: Boolean = false,
@@ -231,6 +235,8 @@ class MainScreenViewModel @Inject constructor(
                 screenState = TranscriptionUiState.Transcribing,
                 transcriptionSegments = repoState.segments,
                 transcriptionProgress = repoState.progress,
+                transcriptionEtaMs = repoState.etaMs,
+                transcriptionSpeed = repoState.speed,
                 detectedLanguage = repoState.detectedLanguage
             )
             is TranscriptionState.Complete -> baseState.copy(
@@ -173,7 +173,7 @@ fun SettingsScreen(
 
                 TurboModeSelector(
                     turboModeEnabled = uiState.turboModeEnabled,
-                    cpuThreads = remember { UserPreferences.getTurboCpuThreads() },
+                    cpuThreads = uiState.turboCpuThreads,
                     onTurboModeChanged = { viewModel.setTurboModeEnabled(it) }
                 )
             }
@@ -31,6 +31,7 @@ data class SettingsUiState(
     val model: String = "",
     val gpuEnabled: Boolean = true,
     val turboModeEnabled: Boolean = false,
+    val turboCpuThreads: Int = UserPreferences.getTurboCpuThreads(),
     val gpuStatus: GpuStatus = GpuStatus.Disabled,
     val numThreads: Int = 4,
     val defaultLanguage: String = UserPreferences.LANGUAGE_AUTO,
@@ -68,6 +69,7 @@ class SettingsViewModel @Inject constructor(
             model = settings.model,
             gpuEnabled = settings.gpuEnabled,
             turboModeEnabled = settings.turboModeEnabled,
+            turboCpuThreads = settings.tuning.turboCpuThreads,
             gpuStatus = gpuStatus,
             numThreads = settings.numThreads,
             defaultLanguage = settings.defaultLanguage,
@@ -63,7 +63,7 @@ class TranscriptionRepositoryImplTest {
 
     @Test
     fun `startRecording transitions to LiveRecording`() = runTest {
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns flowOf()
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns flowOf()
 
         repository.state.test {
             assertThat(awaitItem()).isEqualTo(TranscriptionState.Idle)
@@ -78,7 +78,7 @@ class TranscriptionRepositoryImplTest {
 
     @Test
     fun `startRecording does nothing if not in Idle state`() = runTest {
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns flowOf()
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns flowOf()
 
         repository.startRecording()
         advanceUntilIdle()
@@ -101,7 +101,7 @@ class TranscriptionRepositoryImplTest {
             detectedLanguage = "en"
         )
 
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(recordingProgress)
 
         repository.state.test {
@@ -130,7 +130,7 @@ class TranscriptionRepositoryImplTest {
             detectedLanguage = "en"
         )
 
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(finishingProgress)
 
         repository.state.test {
@@ -157,7 +157,7 @@ class TranscriptionRepositoryImplTest {
             processingTimeMs = 1000
         )
 
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(completeProgress)
 
         repository.state.test {
@@ -178,7 +178,7 @@ class TranscriptionRepositoryImplTest {
 
     @Test
     fun `cancelRecording returns to Idle`() = runTest {
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns flowOf()
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns flowOf()
 
         repository.startRecording()
         advanceUntilIdle()
@@ -192,7 +192,7 @@ class TranscriptionRepositoryImplTest {
     fun `transcribeUri transitions to Transcribing`() = runTest {
         val uri = mockk<Uri>()
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf()
 
         repository.state.test {
@@ -210,8 +210,8 @@ class TranscriptionRepositoryImplTest {
     fun `transcribeUri does nothing if not in Idle`() = runTest {
         val uri = mockk<Uri>()
 
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns flowOf()
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns flowOf()
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf()
 
         repository.startRecording()
@@ -232,10 +232,13 @@ class TranscriptionRepositoryImplTest {
         val transcribingProgress = FileTranscriptionUseCase.Progress.Transcribing(
             progressPercent = 50,
             segments = segments,
-            detectedLanguage = "en"
+            detectedLanguage = "en",
+            processedMs = 30_000,
+            etaMs = 12_000,
+            speed = 2.5f
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(transcribingProgress)
 
         repository.state.test {
@@ -250,6 +253,9 @@ class TranscriptionRepositoryImplTest {
             val transcribing = state as TranscriptionState.Transcribing
             assertThat(transcribing.progress).isEqualTo(50)
             assertThat(transcribing.segments).hasSize(1)
+            assertThat(transcribing.processedMs).isEqualTo(30_000)
+            assertThat(transcribing.etaMs).isEqualTo(12_000)
+            assertThat(transcribing.speed).isEqualTo(2.5f)
         }
     }
 
@@ -262,7 +268,7 @@ class TranscriptionRepositoryImplTest {
             detectedLanguage = null
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(transcribingProgress)
 
         repository.progress.test {
@@ -286,7 +292,7 @@ class TranscriptionRepositoryImplTest {
             processingTimeMs = 2000
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(completeProgress)
 
         repository.state.test {
@@ -308,7 +314,7 @@ class TranscriptionRepositoryImplTest {
     fun `cancelTranscription returns to Idle`() = runTest {
         val uri = mockk<Uri>()
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf()
 
         repository.transcribeUri(uri)
@@ -330,7 +336,7 @@ class TranscriptionRepositoryImplTest {
             processingTimeMs = 100
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(completeProgress)
 
         repository.transcribeUri(uri)
@@ -353,7 +359,7 @@ class TranscriptionRepositoryImplTest {
             processingTimeMs = 100
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(completeProgress)
 
         repository.transcribeUri(uri)
@@ -366,7 +372,7 @@ class TranscriptionRepositoryImplTest {
 
     @Test
     fun `clearState does nothing if not Complete or Error`() = runTest {
-        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any()) } returns flowOf()
+        every { mockLiveTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns flowOf()
 
         repository.startRecording()
         advanceUntilIdle()
@@ -398,7 +404,7 @@ class TranscriptionRepositoryImplTest {
             detectedLanguage = null
         )
 
-        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any()) } returns
+        every { mockFileTranscriptionUseCase.execute(any(), any(), any(), any(), any(), any()) } returns
             flowOf(transcribingProgress)
 
         repository.transcribeUri(uri)
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+package com.voiceskip.domain
+
+import com.google.common.truth.Truth.assertThat
+import com.voiceskip.domain.Autotuner.Candidate
+import com.voiceskip.domain.Autotuner.Measurement
+import com.voiceskip.domain.Autotuner.Mode
+import org.junit.Test
+
+class AutotunerTest {
+
+    // =========================================================================
+    // Candidate Tests
+    // =========================================================================
+
+    @Test
+    fun `CPU only device gets CPU candidates without duplicates`() {
+        val candidates = Autotuner.candidates(maxThreads = 4, highPerfThreads = 3, gpu = false, turboViable = true)
+
+        assertThat(candidates).containsExactly(Candidate(Mode.CPU, 3))
+    }
+
+    @Test
+    fun `turbo candidates need a GPU and a viable device`() {
+        val withTurbo = Autotuner.candidates(maxThreads = 12, highPerfThreads = 4, gpu = true, turboViable = true)
+        val withoutTurbo = Autotuner.candidates(maxThreads = 12, highPerfThreads = 4, gpu = true, turboViable = false)
+
+        assertThat(withTurbo.filter { it.mode == Mode.TURBO }.map { it.numThreads })
+            .containsExactly(4, 8)
+        assertThat(withoutTurbo.map { it.mode })
+            .containsExactly(Mode.CPU, Mode.CPU, Mode.GPU, Mode.GPU, Mode.GPU)
+    }
+
+    @Test
+    fun `GPU candidates sweep the host threads`() {
+        val candidates = Autotuner.candidates(maxThreads = 8, highPerfThreads = 4, gpu = true, turboViable = false)
+
+        assertThat(candidates.filter { it.mode == Mode.GPU }.map { it.gpuThreads })
+            .containsExactly(1, 2, 4)
+    }
+
+    @Test
+    fun `turbo candidates take the host threads of the fastest GPU candidate`() {
+        val candidates = Autotuner.candidates(maxThreads = 12, highPerfThreads = 4, gpu = true, turboViable = true)
+        val measurements = listOf(
+            Measurement(Candidate(Mode.GPU, 1, gpuThreads = 1), 6000),
+            Measurement(Candidate(Mode.GPU, 1, gpuThreads = 2), 4000)
+        )
+
+        val turbo = Autotuner.withGpuThreads(candidates, measurements).filter { it.mode == Mode.TURBO }
+
+        assertThat(turbo.map { it.gpuThreads }.distinct()).containsExactly(2)
+        assertThat(Autotuner.withGpuThreads(candidates, emptyList())).isEqualTo(candidates)
+    }
+
+    // =========================================================================
+    // Pick Tests
+    // =========================================================================
+
+    @Test
+    fun `pick returns null without measurements`() {
+        assertThat(Autotuner.pick(emptyList())).isNull()
+    }
+
+    @Test
+    fun `pick returns the fastest candidate`() {
+        val gpu = Measurement(Candidate(Mode.GPU, 1), 4000)
+        val cpu = Measurement(Candidate(Mode.CPU, 4), 9000)
+
+        assertThat(Autotuner.pick(listOf(cpu, gpu))).isEqualTo(gpu)
+    }
+
+    @Test
+    fun `pick prefers fewer threads within the tie tolerance`() {
+        val turbo = Measurement(Candidate(Mode.TURBO, 7), 5000)
+        val lean = Measurement(Candidate(Mode.TURBO, 4), 5100)
+
+        assertThat(Autotuner.pick(listOf(turbo, lean))).isEqualTo(lean)
+    }
+
+    // =========================================================================
+    // Live Chunk Tests
+    // =========================================================================
+
+    @Test
+    fun `live chunk covers the chunk cost with headroom`() {
+        // 4 chunks in 12s, 3s per chunk, 6s with 50% headroom
+        val measurement = Measurement(Candidate(Mode.GPU, 1), 12_000)
+
+        assertThat(Autotuner.liveMinChunkMs(measurement)).isEqualTo(6_000)
+    }
+
+    @Test
+    fun `live chunk stays within bounds`() {
+        val fast = Measurement(Candidate(Mode.GPU, 1), 1_000)
+        val slow = Measurement(Candidate(Mode.CPU, 2), 200_000)
+
+        assertThat(Autotuner.liveMinChunkMs(fast)).isEqualTo(Autotuner.MIN_LIVE_CHUNK_MS)
+        assertThat(Autotuner.liveMinChunkMs(slow)).isEqualTo(Autotuner.MAX_LIVE_CHUNK_MS)
+    }
+
+    @Test
+    fun `workload is deterministic`() {
+        assertThat(Autotuner.workload()).isEqualTo(Autotuner.workload())
+        assertThat(Autotuner.workload().size).isEqualTo(Autotuner.WORKLOAD_MS / 1000 * 16000)
+    }
+}
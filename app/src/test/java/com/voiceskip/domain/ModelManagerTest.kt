@@ -6,6 +6,7 @@ import android.content.res.AssetManager
 import app.cash.turbine.test
 import com.google.common.truth.Truth.assertThat
 import com.voiceskip.TestDispatcherRule
+import com.voiceskip.data.DeviceTuning
 import com.voiceskip.data.UserPreferences
 import com.voiceskip.fake.FakeTranscriptionRepository
 import com.voiceskip.ui.main.FileManager
@@ -40,6 +41,8 @@ class ModelManagerTest {
     private val modelFlow = MutableStateFlow("ggml-base.en.bin")
     private val gpuEnabledFlow = MutableStateFlow(true)
     private val turboModeHasBeenSetFlow = MutableStateFlow(true)
+    private val turboModeEnabledFlow = MutableStateFlow(false)
+    private val tuningKeyFlow = MutableStateFlow<String?>(TUNING_KEY)
 
     @Before
     fun setup() {
@@ -54,7 +57,14 @@ class ModelManagerTest {
             every { isTurboLoadInProgress() } returns false
             every { setTurboLoadInProgress(any()) } just Runs
             coEvery { setTurboModeEnabled(any(), any()) } just Runs
-            every { shouldAutoEnableTurboForDevice() } returns false
+            every { turboModeEnabled } returns turboModeEnabledFlow
+            every { isTurboViableForDevice() } returns false
+            every { isAutotuneInProgress() } returns false
+            every { setAutotuneInProgress(any()) } just Runs
+            every { getTuningKey(any()) } returns TUNING_KEY
+            every { tuningKey } returns tuningKeyFlow
+            every { tuning } returns MutableStateFlow(DeviceTuning())
+            coEvery { setGpuEnabled(any()) } answers { gpuEnabledFlow.value = firstArg() }
         }
 
         mockFileManager = mockk(relaxed = true) {
@@ -253,4 +263,92 @@ class ModelManagerTest {
 
         verify(exactly = 0) { mockUserPreferences.setGpuInProgress(true) }
     }
+
+    // =========================================================================
+    // Calibration Tests
+    // =========================================================================
+
+    @Test
+    fun `loadModel skips calibration when the tuning key matches`() = runTest {
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        assertThat(fakeRepository.calibrationCalls).isEmpty()
+        coVerify(exactly = 0) { mockUserPreferences.setTuning(any(), any()) }
+    }
+
+    @Test
+    fun `first run calibrates, stores the tuning and picks the mode`() = runTest {
+        tuningKeyFlow.value = null
+        turboModeHasBeenSetFlow.value = false
+
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        assertThat(fakeRepository.calibrationCalls).isNotEmpty()
+        coVerify { mockUserPreferences.setTuning(TUNING_KEY, any()) }
+        coVerify { mockUserPreferences.setCalibratedMode(any(), any(), any()) }
+        verifyOrder {
+            mockUserPreferences.setAutotuneInProgress(true)
+            mockUserPreferences.setAutotuneInProgress(false)
+        }
+        assertThat(modelManager.modelState.value)
+            .isInstanceOf(ModelManager.ModelState.Loaded::class.java)
+    }
+
+    @Test
+    fun `recalibration keeps the mode chosen before`() = runTest {
+        tuningKeyFlow.value = "older build"
+
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        coVerify { mockUserPreferences.setTuning(TUNING_KEY, any()) }
+        coVerify(exactly = 0) { mockUserPreferences.setCalibratedMode(any(), any(), any()) }
+    }
+
+    @Test
+    fun `crash during calibration disables GPU and calibrates on CPU only`() = runTest {
+        tuningKeyFlow.value = null
+        every { mockUserPreferences.isAutotuneInProgress() } returns true
+
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        coVerify { mockUserPreferences.setGpuEnabled(false) }
+        assertThat(modelManager.gpuFallbackReason.value)
+            .isEqualTo(ModelManager.GpuFallbackReason.CRASH)
+        assertThat(fakeRepository.calibrationCalls).isNotEmpty()
+        assertThat(fakeRepository.loadModelUseGpuHistory).doesNotContain(true)
+    }
+
+    @Test
+    fun `GPU disabled by the user is not loaded to calibrate`() = runTest {
+        tuningKeyFlow.value = null
+        gpuEnabledFlow.value = false
+
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        assertThat(fakeRepository.calibrationCalls).isNotEmpty()
+        assertThat(fakeRepository.loadModelUseGpuHistory).doesNotContain(true)
+    }
+
+    @Test
+    fun `failed calibration runs still store a tuning`() = runTest {
+        tuningKeyFlow.value = null
+        fakeRepository.calibrationResult = Result.failure(RuntimeException("timeout"))
+
+        modelManager.loadModel(mockAssets)
+        advanceUntilIdle()
+
+        coVerify { mockUserPreferences.setTuning(TUNING_KEY, any()) }
+        coVerify(exactly = 0) { mockUserPreferences.setCalibratedMode(any(), any(), any()) }
+        assertThat(modelManager.modelState.value)
+            .isInstanceOf(ModelManager.ModelState.Loaded::class.java)
+    }
+
+    private companion object {
+        const val TUNING_KEY = "device|model"
+    }
 }
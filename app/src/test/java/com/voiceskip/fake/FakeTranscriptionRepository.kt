@@ -47,6 +47,7 @@ class FakeTranscriptionRepository : TranscriptionRepository {
 
     var loadModelResult: Result<Boolean> = Result.success(true)
     var loadModelGpuResult: String? = "Test GPU"
+    val loadModelUseGpuHistory = mutableListOf<Boolean>()
 
     private var _isModelLoaded = false
     private var _currentTranscriptionSource: TranscriptionSource? = null
@@ -145,6 +146,7 @@ class FakeTranscriptionRepository : TranscriptionRepository {
         lastLoadModelPath = modelPath
         lastLoadVadModelPath = vadModelPath
         lastLoadModelUseGpu = useGpu
+        loadModelUseGpuHistory += useGpu
 
         return loadModelResult.map { loadModelGpuResult }.also {
             if (it.isSuccess) {
@@ -194,6 +196,21 @@ class FakeTranscriptionRepository : TranscriptionRepository {
 
     override fun isTurboModelLoaded(): Boolean = _isTurboModelLoaded
 
+    var calibrationResult: Result<Long> = Result.success(1000L)
+    val calibrationCalls = mutableListOf<Pair<Int, Int>>()
+
+    override suspend fun runCalibration(
+        samples: FloatArray,
+        numThreads: Int,
+        gpuThreads: Int,
+        minChunkMs: Int,
+        chunkExtendMs: Int,
+        timeoutMs: Long
+    ): Result<Long> {
+        calibrationCalls += numThreads to gpuThreads
+        return calibrationResult
+    }
+
     fun setTurboModelLoaded(loaded: Boolean) {
         _isTurboModelLoaded = loaded
     }
@@ -237,6 +254,8 @@ class FakeTranscriptionRepository : TranscriptionRepository {
         lastLoadModelPath = null
         lastLoadVadModelPath = null
         lastLoadModelUseGpu = null
+        loadModelUseGpuHistory.clear()
+        calibrationCalls.clear()
     }
 
     fun fullReset() {
@@ -250,5 +269,6 @@ class FakeTranscriptionRepository : TranscriptionRepository {
         _currentTranscriptionSource = null
         loadModelResult = Result.success(true)
         loadModelGpuResult = "Test GPU"
+        calibrationResult = Result.success(1000L)
     }
 }
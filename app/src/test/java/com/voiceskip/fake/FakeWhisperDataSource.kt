@@ -45,7 +45,10 @@ class FakeWhisperDataSource : WhisperDataSource {
         val numThreads: Int,
         val language: String?,
         val translate: Boolean,
-        val live: Boolean
+        val live: Boolean,
+        val gpuThreads: Int = 1,
+        val minChunkMs: Int? = null,
+        val chunkExtendMs: Int? = null
     )
 
     override fun loadModel(
@@ -71,11 +74,15 @@ class FakeWhisperDataSource : WhisperDataSource {
         numThreads: Int,
         language: String?,
         translate: Boolean,
-        live: Boolean
+        live: Boolean,
+        gpuThreads: Int,
+        minChunkMs: Int?,
+        chunkExtendMs: Int?
     ) {
         startStreamCalled = true
         startStreamCalls.add(
-            StartStreamCall(audioProvider, numThreads, language, translate, live)
+            StartStreamCall(audioProvider, numThreads, language, translate, live,
+                gpuThreads, minChunkMs, chunkExtendMs)
         )
     }
 
@@ -41,6 +41,21 @@ data class WhisperSegment(
     }
 }
 
+/**
+ * Transcription progress reported while streaming.
+ *
+ * @param percent Overall progress (0-100), -1 when the duration is unknown
+ * @param processedMs Audio transcribed so far, valid even when the duration is unknown
+ * @param etaMs Estimated remaining time, -1 when the duration or speed is unknown
+ * @param speed Smoothed throughput in audio seconds per second (all contexts combined)
+ */
+data class WhisperProgress(
+    val percent: Int,
+    val processedMs: Long,
+    val etaMs: Long,
+    val speed: Float
+)
+
 /**
  * Interface for providing audio samples to the streaming transcription.
  * Implementations should be thread-safe as readAudio is called from a native thread.
@@ -61,7 +76,7 @@ interface AudioProvider {
  * Usage:
  * ```
  * val whisper = WhisperContext.create(
- *     onProgress = { progress -> Log.d(TAG, "Progress: $progress%") },
+ *     onProgress = { progress -> Log.d(TAG, "Progress: ${progress.percent}%") },
  *     onLoaded = { gpuUsed -> Log.d(TAG, "Model loaded! GPU: $gpuUsed") },
  *     onSegment = { segment -> Log.d(TAG, "Segment: ${segment.text}") },
  *     onStreamComplete = { success -> Log.d(TAG, "Stream complete: $success") }
@@ -75,7 +90,7 @@ interface AudioProvider {
  */
 @Keep
 class WhisperContext private constructor(
-    private val progressCallback: ((Int) -> Unit)? = null,
+    private val progressCallback: ((WhisperProgress) -> Unit)? = null,
     private val loadedCallback: ((slotIndex: Int, gpuInfo: String?) -> Unit)? = null,
     private val newSegmentCallback: ((WhisperSegment) -> Unit)? = null,
     private val streamCompleteCallback: ((Boolean) -> Unit)? = null,
@@ -93,8 +108,8 @@ class WhisperContext private constructor(
 
     @Keep
     @Suppress("unused") // Called from JNI
-    fun onProgress(progress: Int) {
-        progressCallback?.invoke(progress)
+    fun onProgress(percent: Int, processedMs: Long, etaMs: Long, speed: Float) {
+        progressCallback?.invoke(WhisperProgress(percent, processedMs, etaMs, speed))
     }
 
     @Keep
@@ -136,16 +151,19 @@ class WhisperContext private constructor(
      * @param modelPath Path to the model file within assets
      * @param vadModelPath Optional path to VAD model for silence detection
      * @param useGpu Whether to use GPU acceleration (Vulkan)
+     * @param trustGpu Use the GPU even if its driver is on the built-in blocklist. An
+     *   explicit opt-in for drivers known to work: never set it to probe a GPU
      */
     fun loadModel(
         assetManager: AssetManager,
         modelPath: String,
         vadModelPath: String? = null,
-        useGpu: Boolean = true
+        useGpu: Boolean = true,
+        trustGpu: Boolean = false
     ) {
         require(mInstance != 0L) { "WhisperContext not initialized" }
-        Log.d(LOG_TAG, "Loading model: $modelPath, vadModel: $vadModelPath, useGpu: $useGpu")
-        nativeLoadModel(assetManager, modelPath, vadModelPath, useGpu)
+        Log.d(LOG_TAG, "Loading model: $modelPath, vadModel: $vadModelPath, useGpu: $useGpu, trustGpu: $trustGpu")
+        nativeLoadModel(assetManager, modelPath, vadModelPath, useGpu, trustGpu)
     }
 
     /**
@@ -171,23 +189,31 @@ class WhisperContext private constructor(
      * The stream will pull audio from the AudioProvider until it returns 0 (EOF) or stop() is called.
      *
      * @param audioProvider Provider that supplies audio samples
-     * @param numThreads Number of threads for transcription
+     * @param numThreads Number of threads for CPU transcription
      * @param language Language code or null for auto-detect
      * @param translate If true, translate to English
      * @param live True for live recording, false for file transcription
+     * @param gpuThreads Host threads of the GPU context
+     * @param minChunkMs Minimum chunk length, null for the live or file default
+     * @param chunkExtendMs Time searched for silence past minChunkMs, null for the default
      */
     fun startStream(
         audioProvider: AudioProvider,
         numThreads: Int,
         language: String? = null,
         translate: Boolean = false,
-        live: Boolean = false
+        live: Boolean = false,
+        gpuThreads: Int = 1,
+        minChunkMs: Int? = null,
+        chunkExtendMs: Int? = null
     ) {
         require(mInstance != 0L) { "WhisperContext not initialized" }
         this.audioProvider = audioProvider
-        Log.d(LOG_TAG, "Starting stream: threads=$numThreads, lang=$language, " +
-                "translate=$translate, live=$live")
-        nativeStart(numThreads, language, translate, live)
+        Log.d(LOG_TAG, "Starting stream: threads=$numThreads, gpuThreads=$gpuThreads, " +
+                "lang=$language, translate=$translate, live=$live, " +
+                "chunk=${minChunkMs ?: "default"}+${chunkExtendMs ?: "default"}")
+        nativeStart(numThreads, gpuThreads, language, translate, live,
+                minChunkMs ?: -1, chunkExtendMs ?: -1)
     }
 
     /**
@@ -201,8 +227,9 @@ class WhisperContext private constructor(
     }
 
     /**
-     * Set total audio duration for progress calculation.
-     * Can be called while streaming. Set to 0 to disable progress callbacks.
+     * Set total audio duration for progress and ETA calculation.
+     * Can be called while streaming. Set to 0 if unknown: progress is then reported
+     * with percent = -1 and etaMs = -1.
      */
     fun setDuration(durationMs: Long) {
         require(mInstance != 0L) { "WhisperContext not initialized" }
@@ -232,14 +259,18 @@ class WhisperContext private constructor(
         assetManager: AssetManager,
         modelPath: String,
         vadModelPath: String?,
-        useGpu: Boolean
+        useGpu: Boolean,
+        trustGpu: Boolean
     )
     private external fun nativeLoadSecondModel(assetManager: AssetManager?, modelPath: String?, vadModelPath: String?)
     private external fun nativeStart(
         numThreads: Int,
+        gpuThreads: Int,
         language: String?,
         translate: Boolean,
-        live: Boolean
+        live: Boolean,
+        minChunkMs: Int,
+        chunkExtendMs: Int
     )
     private external fun nativeStop()
     private external fun nativeSetDuration(durationMs: Long)
@@ -251,7 +282,11 @@ class WhisperContext private constructor(
             Log.d(LOG_TAG, "Primary ABI: ${Build.SUPPORTED_ABIS[0]}")
             var libraryLoaded = false
 
-            if (isArmEabiV8a()) {
+            // Loading runs none of the kernels, a CPU without fp16 arithmetic or
+            // dotprod would only fail later with SIGILL: check the hwcaps first.
+            // Builds with CPU dispatch have no such library and pick the kernels
+            // in JNI_OnLoad.
+            if (isArmEabiV8a() && cpuHasFeatures("asimdhp", "asimddp")) {
                 try {
                     Log.d(LOG_TAG, "Trying to load libwhisper_v8fp16_dotprod.so")
                     System.loadLibrary("whisper_v8fp16_dotprod")
@@ -262,17 +297,6 @@ class WhisperContext private constructor(
                 }
             }
 
-            if (!libraryLoaded && (isArmEabiV7a() || isArmEabiV8a())) {
-                try {
-                    Log.d(LOG_TAG, "Trying to load libwhisper_vfpv4.so")
-                    System.loadLibrary("whisper_vfpv4")
-                    libraryLoaded = true
-                    Log.d(LOG_TAG, "Successfully loaded libwhisper_vfpv4.so")
-                } catch (e: Throwable) {
-                    Log.w(LOG_TAG, "Failed to load whisper_vfpv4: ${e.message}")
-                }
-            }
-
             if (!libraryLoaded) {
                 Log.d(LOG_TAG, "Loading libwhisper.so")
                 System.loadLibrary("whisper")
@@ -282,14 +306,14 @@ class WhisperContext private constructor(
         /**
          * Create a new WhisperContext instance with optional callbacks
          *
-         * @param onProgress Called during transcription with progress percentage (0-100)
+         * @param onProgress Called during transcription with progress, ETA and throughput
          * @param onLoaded Called when model loading completes (slotIndex = 0 for main, 1 for turbo; gpuInfo = GPU device name if Vulkan active, null for CPU)
          * @param onSegment Called when a new segment is transcribed (includes detected language)
          * @param onStreamComplete Called when streaming transcription completes (success = true if no errors)
          * @param onError Called when an error occurs in the JNI layer
          */
         fun create(
-            onProgress: ((Int) -> Unit)? = null,
+            onProgress: ((WhisperProgress) -> Unit)? = null,
             onLoaded: ((slotIndex: Int, gpuInfo: String?) -> Unit)? = null,
             onSegment: ((WhisperSegment) -> Unit)? = null,
             onStreamComplete: ((success: Boolean) -> Unit)? = null,
@@ -298,12 +322,19 @@ class WhisperContext private constructor(
             return WhisperContext(onProgress, onLoaded, onSegment, onStreamComplete, onError)
         }
 
-        private fun isArmEabiV7a(): Boolean {
-            return Build.SUPPORTED_ABIS[0].equals("armeabi-v7a")
-        }
-
         private fun isArmEabiV8a(): Boolean {
             return Build.SUPPORTED_ABIS[0].equals("arm64-v8a")
         }
+
+        /** All of [features] in the Features line of /proc/cpuinfo */
+        private fun cpuHasFeatures(vararg features: String): Boolean {
+            val line = try {
+                File("/proc/cpuinfo").useLines { lines -> lines.firstOrNull { it.startsWith("Features") } }
+            } catch (e: Exception) {
+                null
+            } ?: return false
+            val present = line.substringAfter(':').trim().split(Regex("\\s+")).toSet()
+            return features.all { it in present }
+        }
     }
 }
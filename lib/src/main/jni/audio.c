@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include "audio.h"
+
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+#include <libswresample/swresample.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <whisper.h>
+
+struct decode_ctx
+{
+    AVFormatContext *fmt_ctx;
+    AVCodecContext *codec_ctx;
+    AVPacket *pkt;
+    AVFrame *frame;
+    SwrContext *swr_ctx;
+    float *samples;
+    int sample_count;
+    int sample_capacity;
+};
+
+static int
+ensure_capacity(struct decode_ctx *d, int needed)
+{
+    if (d->sample_count + needed <= d->sample_capacity)
+        return 0;
+
+    int new_cap = d->sample_capacity ? d->sample_capacity * 2 : 1024 * 1024;
+    while (new_cap < d->sample_count + needed)
+        new_cap *= 2;
+    float *tmp = realloc(d->samples, new_cap * sizeof(float));
+    if (!tmp)
+        return -1;
+    d->samples = tmp;
+    d->sample_capacity = new_cap;
+    return 0;
+}
+
+static int
+drain_frames(struct decode_ctx *d)
+{
+    while (avcodec_receive_frame(d->codec_ctx, d->frame) >= 0)
+    {
+        int out_samples = swr_get_out_samples(d->swr_ctx, d->frame->nb_samples);
+        if (ensure_capacity(d, out_samples) < 0)
+        {
+            av_frame_unref(d->frame);
+            return -1;
+        }
+
+        uint8_t *out_buf = (uint8_t *)(d->samples + d->sample_count);
+        int converted = swr_convert(d->swr_ctx, &out_buf, out_samples,
+                                    (const uint8_t **)d->frame->extended_data,
+                                    d->frame->nb_samples);
+        if (converted > 0)
+            d->sample_count += converted;
+
+        av_frame_unref(d->frame);
+    }
+    return 0;
+}
+
+static int
+flush_resampler(struct decode_ctx *d)
+{
+    while (swr_get_delay(d->swr_ctx, WHISPER_SAMPLE_RATE) > 0)
+    {
+        if (ensure_capacity(d, 1024) < 0)
+            return -1;
+        uint8_t *out_buf = (uint8_t *)(d->samples + d->sample_count);
+        int converted = swr_convert(d->swr_ctx, &out_buf, 1024, NULL, 0);
+        if (converted <= 0)
+            break;
+        d->sample_count += converted;
+    }
+    return 0;
+}
+
+static void
+decode_ctx_free(struct decode_ctx *d)
+{
+    free(d->samples);
+    av_frame_free(&d->frame);
+    av_packet_free(&d->pkt);
+    swr_free(&d->swr_ctx);
+    avcodec_free_context(&d->codec_ctx);
+    avformat_close_input(&d->fmt_ctx);
+}
+
+float *
+read_avcodec(const char *path, int *n_samples)
+{
+    struct decode_ctx d = {0};
+
+    if (avformat_open_input(&d.fmt_ctx, path, NULL, NULL) < 0)
+    {
+        fprintf(stderr, "Failed to open: %s\n", path);
+        return NULL;
+    }
+
+    if (avformat_find_stream_info(d.fmt_ctx, NULL) < 0)
+    {
+        fprintf(stderr, "Failed to find stream info\n");
+        goto cleanup;
+    }
+
+    int stream_idx = av_find_best_stream(d.fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, NULL, 0);
+    if (stream_idx < 0)
+    {
+        fprintf(stderr, "No audio stream found\n");
+        goto cleanup;
+    }
+
+    AVStream *stream = d.fmt_ctx->streams[stream_idx];
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec)
+    {
+        fprintf(stderr, "Unsupported codec\n");
+        goto cleanup;
+    }
+
+    d.codec_ctx = avcodec_alloc_context3(codec);
+    if (!d.codec_ctx)
+        goto cleanup;
+
+    if (avcodec_parameters_to_context(d.codec_ctx, stream->codecpar) < 0)
+        goto cleanup;
+
+    d.codec_ctx->thread_count = 1;
+
+    if (avcodec_open2(d.codec_ctx, codec, NULL) < 0)
+    {
+        fprintf(stderr, "Failed to open codec\n");
+        goto cleanup;
+    }
+
+    AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
+    if (swr_alloc_set_opts2(&d.swr_ctx,
+                            &out_layout, AV_SAMPLE_FMT_FLT, WHISPER_SAMPLE_RATE,
+                            &d.codec_ctx->ch_layout, d.codec_ctx->sample_fmt, d.codec_ctx->sample_rate,
+                            0, NULL) < 0)
+        goto cleanup;
+
+    if (swr_init(d.swr_ctx) < 0)
+    {
+        fprintf(stderr, "Failed to init resampler\n");
+        goto cleanup;
+    }
+
+    d.pkt = av_packet_alloc();
+    d.frame = av_frame_alloc();
+    if (!d.pkt || !d.frame)
+        goto cleanup;
+
+    while (av_read_frame(d.fmt_ctx, d.pkt) >= 0)
+    {
+        if (d.pkt->stream_index != stream_idx)
+        {
+            av_packet_unref(d.pkt);
+            continue;
+        }
+
+        if (avcodec_send_packet(d.codec_ctx, d.pkt) < 0)
+        {
+            av_packet_unref(d.pkt);
+            continue;
+        }
+
+        if (drain_frames(&d) < 0)
+            goto cleanup;
+
+        av_packet_unref(d.pkt);
+    }
+
+    /* Flush decoder */
+    avcodec_send_packet(d.codec_ctx, NULL);
+    if (drain_frames(&d) < 0)
+        goto cleanup;
+
+    if (flush_resampler(&d) < 0)
+        goto cleanup;
+
+    *n_samples = d.sample_count;
+
+    float *samples = d.samples;
+    d.samples = NULL;
+    decode_ctx_free(&d);
+    return samples;
+
+cleanup:
+    decode_ctx_free(&d);
+    *n_samples = 0;
+    return NULL;
+}
+
+int
+file_read_cb(float *out, int n_max, void *user_data)
+{
+    struct file_ctx *ctx = user_data;
+    int remaining = ctx->n_samples - ctx->pos;
+    int n = (n_max < remaining) ? n_max : remaining;
+    if (n > 0)
+    {
+        memcpy(out, ctx->samples + ctx->pos, n * sizeof(float));
+        ctx->pos += n;
+    }
+    return n;
+}
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Decode any audio/video file to 16 kHz mono float samples.
+ * Returns a malloc()ed buffer, NULL on error. */
+float *
+read_avcodec(const char *path, int *n_samples);
+
+struct file_ctx
+{
+    const float *samples;
+    int n_samples;
+    int pos;
+};
+
+/* whisper_stream_read_callback reading from a struct file_ctx */
+int
+file_read_cb(float *out, int n_max, void *user_data);
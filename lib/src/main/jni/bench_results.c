@@ -0,0 +1,270 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include "bench_results.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+/* Memory is deterministic, ignore changes below this */
+#define MEM_NOISE_BYTES (1024 * 1024)
+
+/* Keeps the value printable inside a JSON string */
+static void
+sanitize(char *s)
+{
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\' || (unsigned char)*s < 0x20)
+            *s = ' ';
+    }
+}
+
+static void
+trim(char *s)
+{
+    size_t len = strlen(s);
+    while (len > 0 && (s[len - 1] == '\n' || s[len - 1] == ' ' || s[len - 1] == '\t'))
+        s[--len] = '\0';
+}
+
+static void
+detect_cpu(char *out, size_t size)
+{
+    static const char *const keys[] = { "model name", "Hardware", "CPU part" };
+    char line[256];
+    /* Sized so that the prefix and the name fit host->cpu */
+    char found[3][sizeof ((struct bench_host *)0)->cpu - sizeof "CPU part " + 1] = { "", "", "" };
+
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f)
+    {
+        while (fgets(line, sizeof line, f))
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                char *colon = strchr(line, ':');
+                if (found[k][0] || !colon || strncmp(line, keys[k], strlen(keys[k])) != 0)
+                    continue;
+                snprintf(found[k], sizeof found[k], "%s", colon + 2);
+                trim(found[k]);
+            }
+        }
+        fclose(f);
+    }
+
+    for (int k = 0; k < 3; k++)
+    {
+        if (found[k][0])
+        {
+            snprintf(out, size, "%s%.*s", k == 2 ? "CPU part " : "",
+                     (int)sizeof found[k] - 1, found[k]);
+            sanitize(out);
+            return;
+        }
+    }
+
+    struct utsname u;
+    snprintf(out, size, "%s", uname(&u) == 0 ? u.machine : "unknown");
+    sanitize(out);
+}
+
+void
+bench_host_detect(struct bench_host *host, const char *commit)
+{
+    memset(host, 0, sizeof *host);
+
+    if (commit)
+    {
+        snprintf(host->commit, sizeof host->commit, "%s", commit);
+    }
+    else
+    {
+        FILE *p = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+        if (p)
+        {
+            if (fgets(host->commit, sizeof host->commit, p))
+                trim(host->commit);
+            pclose(p);
+        }
+        if (!host->commit[0])
+            strcpy(host->commit, "unknown");
+    }
+    sanitize(host->commit);
+
+    detect_cpu(host->cpu, sizeof host->cpu);
+    host->n_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+/* One result per line so that bench_results_load() can stay a line parser */
+#define RESULT_FMT_OUT \
+    "    {\"model\": \"%s\", \"mode\": \"%s\", \"threads\": %d, \"audio_ms\": %lld, \"n\": %d, " \
+    "\"load_ms\": %.1f, \"load_ci\": %.1f, \"transcribe_ms\": %.1f, \"transcribe_ci\": %.1f, " \
+    "\"rtf\": %.4f, \"rtf_ci\": %.4f, \"mem_peak_bytes\": %zu}"
+#define RESULT_FMT_IN \
+    " {\"model\": \"%63[^\"]\", \"mode\": \"%15[^\"]\", \"threads\": %d, \"audio_ms\": %lld, \"n\": %d, " \
+    "\"load_ms\": %lf, \"load_ci\": %lf, \"transcribe_ms\": %lf, \"transcribe_ci\": %lf, " \
+    "\"rtf\": %lf, \"rtf_ci\": %lf, \"mem_peak_bytes\": %zu}"
+
+int
+bench_results_save(const char *path, const struct bench_host *host,
+                   const struct bench_result *results, int n_results)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to create %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"commit\": \"%s\",\n", host->commit);
+    fprintf(f, "  \"cpu\": \"%s\",\n", host->cpu);
+    fprintf(f, "  \"n_cpus\": %d,\n", host->n_cpus);
+    fprintf(f, "  \"results\": [\n");
+    for (int i = 0; i < n_results; i++)
+    {
+        char model[64], mode[16];
+        const struct bench_result *r = &results[i];
+        snprintf(model, sizeof model, "%s", r->model);
+        snprintf(mode, sizeof mode, "%s", r->mode);
+        sanitize(model);
+        sanitize(mode);
+        fprintf(f, RESULT_FMT_OUT "%s\n", model, mode, r->threads,
+                (long long)r->audio_ms, r->n, r->load_ms, r->load_ci,
+                r->transcribe_ms, r->transcribe_ci, r->rtf, r->rtf_ci,
+                r->mem_peak, i + 1 < n_results ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+
+    int ret = ferror(f) ? -1 : 0;
+    if (fclose(f) != 0)
+        ret = -1;
+    return ret;
+}
+
+int
+bench_results_load(const char *path, struct bench_host *host,
+                   struct bench_result **results, int *n_results)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return -1;
+    }
+
+    memset(host, 0, sizeof *host);
+    *results = NULL;
+    *n_results = 0;
+    int cap = 0;
+    char line[1024];
+
+    while (fgets(line, sizeof line, f))
+    {
+        if (sscanf(line, " \"commit\": \"%47[^\"]\"", host->commit) == 1
+            || sscanf(line, " \"cpu\": \"%127[^\"]\"", host->cpu) == 1
+            || sscanf(line, " \"n_cpus\": %d", &host->n_cpus) == 1)
+            continue;
+
+        struct bench_result r;
+        long long audio_ms;
+        memset(&r, 0, sizeof r);
+        if (sscanf(line, RESULT_FMT_IN, r.model, r.mode, &r.threads, &audio_ms, &r.n,
+                   &r.load_ms, &r.load_ci, &r.transcribe_ms, &r.transcribe_ci,
+                   &r.rtf, &r.rtf_ci, &r.mem_peak) != 12)
+            continue;
+        r.audio_ms = audio_ms;
+
+        if (*n_results == cap)
+        {
+            cap = cap ? cap * 2 : 16;
+            struct bench_result *tmp = realloc(*results, cap * sizeof *tmp);
+            if (!tmp)
+            {
+                free(*results);
+                *results = NULL;
+                fclose(f);
+                return -1;
+            }
+            *results = tmp;
+        }
+        (*results)[(*n_results)++] = r;
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Returns 1 for a regression, -1 for an improvement, 0 within noise */
+static int
+compare_metric(const char *what, const struct bench_result *r,
+               double base, double base_ci, double cur, double cur_ci,
+               double threshold, const char *unit)
+{
+    if (base <= 0)
+        return 0;
+
+    double noise = sqrt(base_ci * base_ci + cur_ci * cur_ci);
+    double limit = fmax(threshold * base, noise);
+    double delta = cur - base;
+
+    if (fabs(delta) <= limit)
+        return 0;
+
+    printf("%s: %s %s %d threads %lldms: %s %.4g%s -> %.4g%s (%+.1f%%, limit %.1f%%)\n",
+           delta > 0 ? "REGRESSION" : "IMPROVED", r->model, r->mode, r->threads,
+           (long long)r->audio_ms, what, base, unit, cur, unit,
+           delta * 100.0 / base, limit * 100.0 / base);
+    return delta > 0 ? 1 : -1;
+}
+
+int
+bench_results_compare(const struct bench_host *base_host,
+                      const struct bench_result *base, int n_base,
+                      const struct bench_host *cur_host,
+                      const struct bench_result *cur, int n_cur,
+                      double threshold)
+{
+    int regressions = 0;
+
+    if (strcmp(base_host->cpu, cur_host->cpu) != 0 || base_host->n_cpus != cur_host->n_cpus)
+        fprintf(stderr, "Warning: baseline from another host (%s, %d CPUs)\n",
+                base_host->cpu, base_host->n_cpus);
+
+    printf("Baseline %s, current %s\n", base_host->commit, cur_host->commit);
+
+    for (int i = 0; i < n_cur; i++)
+    {
+        const struct bench_result *c = &cur[i];
+        const struct bench_result *b = NULL;
+        for (int j = 0; j < n_base && !b; j++)
+        {
+            if (strcmp(base[j].model, c->model) == 0 && strcmp(base[j].mode, c->mode) == 0
+                && base[j].threads == c->threads && base[j].audio_ms == c->audio_ms)
+                b = &base[j];
+        }
+        if (!b)
+        {
+            printf("NEW: %s %s %d threads %lldms\n", c->model, c->mode, c->threads,
+                   (long long)c->audio_ms);
+            continue;
+        }
+
+        regressions += compare_metric("RTF", c, b->rtf, b->rtf_ci, c->rtf, c->rtf_ci,
+                                      threshold, "x") > 0;
+        regressions += compare_metric("load", c, b->load_ms, b->load_ci,
+                                      c->load_ms, c->load_ci, threshold, "ms") > 0;
+
+        /* No CI for memory, only the threshold and a floor */
+        double mem_base = (double)b->mem_peak;
+        double mem_floor = mem_base > 0 ? MEM_NOISE_BYTES / mem_base : 0;
+        regressions += compare_metric("memory", c, mem_base / 1048576.0, 0,
+                                      c->mem_peak / 1048576.0, 0,
+                                      fmax(threshold, mem_floor), "MiB") > 0;
+    }
+    return regressions;
+}
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* One model/mode/audio configuration, means and 95% CI half-widths */
+struct bench_result
+{
+    char model[64];
+    char mode[16];
+    int threads;
+    int64_t audio_ms;
+    int n;
+
+    double load_ms;
+    double load_ci;
+    double transcribe_ms;
+    double transcribe_ci;
+    double rtf;
+    double rtf_ci;
+    size_t mem_peak;            /* bytes, sum of the sampled maxima of all slots
+                                 * and shared buffers ("mem_peak_bytes" in JSON) */
+};
+
+struct bench_host
+{
+    char commit[48];
+    char cpu[128];
+    int n_cpus;
+};
+
+/* commit may be NULL to ask git */
+void
+bench_host_detect(struct bench_host *host, const char *commit);
+
+int
+bench_results_save(const char *path, const struct bench_host *host,
+                   const struct bench_result *results, int n_results);
+
+/* Reads a file written by bench_results_save(), *results is malloc()ed */
+int
+bench_results_load(const char *path, struct bench_host *host,
+                   struct bench_result **results, int *n_results);
+
+/* Prints regressions and improvements of cur over base beyond both
+ * threshold (relative) and the combined confidence intervals.
+ * Returns the number of regressions. */
+int
+bench_results_compare(const struct bench_host *base_host,
+                      const struct bench_result *base, int n_base,
+                      const struct bench_host *cur_host,
+                      const struct bench_result *cur, int n_cur,
+                      double threshold);
@@ -0,0 +1,596 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Runs a grid of chunking parameters over a corpus with reference
+ * transcripts and reports speed, WER and where chunks were cut.
+ * The reference of foo.opus is foo.txt, WER is skipped without one. */
+
+#include "audio.h"
+#include "stream.h"
+
+#include <ctype.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_GRID 16
+
+struct grid
+{
+    float values[MAX_GRID];
+    int n;
+};
+
+struct sweep_point
+{
+    int min_chunk_ms;
+    int chunk_extend_ms;
+    int overlap_ms;
+    int min_silence_ms;
+    float vad_threshold;
+};
+
+struct segment
+{
+    int64_t t0;
+    char *text;
+};
+
+/* Filled by the callbacks of one run, both slots report concurrently */
+struct run_ctx
+{
+    pthread_mutex_t mutex;
+
+    struct segment *segs;
+    int n_segs;
+    int cap_segs;
+
+    int n_cuts[3];              /* by enum whisper_stream_cut */
+    int64_t chunk_samples_sum;
+    int chunk_samples_min;
+    int chunk_samples_max;
+};
+
+struct corpus_file
+{
+    const char *path;
+    float *samples;
+    int n_samples;
+    char *reference;            /* NULL if none */
+};
+
+struct point_result
+{
+    double audio_s;
+    double transcribe_s;
+    int64_t word_errors;
+    int64_t ref_words;
+    int n_cuts[3];
+    int n_chunks;
+    int64_t chunk_samples_sum;
+    int chunk_samples_min;
+    int chunk_samples_max;
+    int failures;
+};
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+log_disable(enum ggml_log_level level, const char *text, void *user_data)
+{
+    (void)level;
+    (void)text;
+    (void)user_data;
+}
+
+static int
+parse_grid(const char *list, struct grid *g)
+{
+    g->n = 0;
+    while (*list)
+    {
+        if (g->n == MAX_GRID)
+        {
+            fprintf(stderr, "At most %d values per parameter\n", MAX_GRID);
+            return -1;
+        }
+        char *end;
+        g->values[g->n++] = strtof(list, &end);
+        if (end == list || (*end && *end != ','))
+        {
+            fprintf(stderr, "Bad value list: %s\n", list);
+            return -1;
+        }
+        list = *end ? end + 1 : end;
+    }
+    return g->n > 0 ? 0 : -1;
+}
+
+static void
+segment_cb(struct whisper_context *ctx, const struct whisper_stream_segment *seg,
+           void *user_data)
+{
+    (void)ctx;
+    struct run_ctx *run = user_data;
+
+    pthread_mutex_lock(&run->mutex);
+    if (run->n_segs == run->cap_segs)
+    {
+        int cap = run->cap_segs ? run->cap_segs * 2 : 64;
+        struct segment *tmp = realloc(run->segs, cap * sizeof *tmp);
+        if (!tmp)
+        {
+            pthread_mutex_unlock(&run->mutex);
+            return;
+        }
+        run->segs = tmp;
+        run->cap_segs = cap;
+    }
+    char *text = strdup(seg->text);
+    if (text)
+        run->segs[run->n_segs++] = (struct segment){ seg->t0, text };
+    pthread_mutex_unlock(&run->mutex);
+}
+
+static void
+chunk_cb(const struct whisper_stream_chunk_stats *chunk, void *user_data)
+{
+    struct run_ctx *run = user_data;
+
+    pthread_mutex_lock(&run->mutex);
+    if ((unsigned)chunk->cut < 3)
+        run->n_cuts[chunk->cut]++;
+    run->chunk_samples_sum += chunk->samples;
+    if (chunk->samples < run->chunk_samples_min)
+        run->chunk_samples_min = chunk->samples;
+    if (chunk->samples > run->chunk_samples_max)
+        run->chunk_samples_max = chunk->samples;
+    pthread_mutex_unlock(&run->mutex);
+}
+
+static int
+cmp_segment(const void *a, const void *b)
+{
+    const struct segment *x = a, *y = b;
+    return (x->t0 > y->t0) - (x->t0 < y->t0);
+}
+
+/* Lower-cased words without punctuation, in place. Returns the count. */
+static int
+split_words(char *text, char ***words_out)
+{
+    int cap = 64, n = 0;
+    char **words = malloc(cap * sizeof *words);
+    if (!words)
+        return -1;
+
+    char *w = NULL;
+    char *out = text;
+    for (char *p = text;; p++)
+    {
+        unsigned char c = *p;
+        bool word_char = c && (isalnum(c) || c == '\'' || c >= 0x80);
+        if (word_char)
+        {
+            if (!w)
+                w = out;
+            *out++ = (char)tolower(c);
+            continue;
+        }
+        if (w)
+        {
+            *out++ = '\0';
+            if (n == cap)
+            {
+                cap *= 2;
+                char **tmp = realloc(words, cap * sizeof *tmp);
+                if (!tmp)
+                {
+                    free(words);
+                    return -1;
+                }
+                words = tmp;
+            }
+            words[n++] = w;
+            w = NULL;
+        }
+        if (!c)
+            break;
+    }
+    *words_out = words;
+    return n;
+}
+
+/* Word-level edit distance between hypothesis and reference */
+static int64_t
+word_errors(const char *hyp_text, const char *ref_text, int64_t *n_ref)
+{
+    char *hyp_buf = strdup(hyp_text);
+    char *ref_buf = strdup(ref_text);
+    char **hyp = NULL, **ref = NULL;
+    int64_t *row = NULL;
+    int64_t errors = -1;
+
+    if (!hyp_buf || !ref_buf)
+        goto cleanup;
+
+    int nh = split_words(hyp_buf, &hyp);
+    int nr = split_words(ref_buf, &ref);
+    if (nh < 0 || nr < 0)
+        goto cleanup;
+
+    row = malloc((nr + 1) * sizeof *row);
+    if (!row)
+        goto cleanup;
+
+    for (int j = 0; j <= nr; j++)
+        row[j] = j;
+    for (int i = 1; i <= nh; i++)
+    {
+        int64_t diag = row[0];
+        row[0] = i;
+        for (int j = 1; j <= nr; j++)
+        {
+            int64_t up = row[j];
+            int64_t best = diag + (strcmp(hyp[i - 1], ref[j - 1]) != 0);
+            if (up + 1 < best)
+                best = up + 1;
+            if (row[j - 1] + 1 < best)
+                best = row[j - 1] + 1;
+            row[j] = best;
+            diag = up;
+        }
+    }
+    errors = row[nr];
+    *n_ref = nr;
+
+cleanup:
+    free(row);
+    free(hyp);
+    free(ref);
+    free(hyp_buf);
+    free(ref_buf);
+    return errors;
+}
+
+static char *
+read_reference(const char *audio_path)
+{
+    const char *dot = strrchr(audio_path, '.');
+    const char *slash = strrchr(audio_path, '/');
+    size_t base_len = (dot && (!slash || dot > slash)) ? (size_t)(dot - audio_path)
+                                                        : strlen(audio_path);
+    char *path = malloc(base_len + 5);
+    if (!path)
+        return NULL;
+    memcpy(path, audio_path, base_len);
+    strcpy(path + base_len, ".txt");
+
+    FILE *f = fopen(path, "rb");
+    free(path);
+    if (!f)
+        return NULL;
+
+    char *text = NULL;
+    size_t len = 0, cap = 0;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, f)) > 0)
+    {
+        if (len + n + 1 > cap)
+        {
+            cap = (len + n + 1) * 2;
+            char *tmp = realloc(text, cap);
+            if (!tmp)
+            {
+                free(text);
+                fclose(f);
+                return NULL;
+            }
+            text = tmp;
+        }
+        memcpy(text + len, buf, n);
+        len += n;
+    }
+    fclose(f);
+    if (text)
+        text[len] = '\0';
+    return text;
+}
+
+/* Joins the segments in time order, frees them */
+static char *
+join_segments(struct run_ctx *run)
+{
+    qsort(run->segs, run->n_segs, sizeof *run->segs, cmp_segment);
+
+    size_t len = 1;
+    for (int i = 0; i < run->n_segs; i++)
+        len += strlen(run->segs[i].text) + 1;
+
+    char *text = malloc(len);
+    if (text)
+    {
+        char *p = text;
+        for (int i = 0; i < run->n_segs; i++)
+            p += sprintf(p, "%s ", run->segs[i].text);
+        *p = '\0';
+    }
+
+    for (int i = 0; i < run->n_segs; i++)
+        free(run->segs[i].text);
+    free(run->segs);
+    run->segs = NULL;
+    run->n_segs = run->cap_segs = 0;
+    return text;
+}
+
+static void
+run_point(const struct sweep_point *pt, struct whisper_stream_slot slots[2],
+          struct corpus_file *files, int n_files, struct point_result *res)
+{
+    memset(res, 0, sizeof *res);
+    res->chunk_samples_min = INT32_MAX;
+
+    for (int f = 0; f < n_files; f++)
+    {
+        struct run_ctx run = {0};
+        pthread_mutex_init(&run.mutex, NULL);
+        run.chunk_samples_min = INT32_MAX;
+
+        struct file_ctx fctx = { files[f].samples, files[f].n_samples, 0 };
+
+        struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        wparams.suppress_nst = true;
+
+        struct whisper_stream_params sparams = whisper_stream_default_params();
+        sparams.read_callback = file_read_cb;
+        sparams.read_callback_user_data = &fctx;
+        sparams.segment_callback = segment_cb;
+        sparams.segment_callback_user_data = &run;
+        sparams.chunk_callback = chunk_cb;
+        sparams.chunk_callback_user_data = &run;
+        sparams.slots[0] = slots[0];
+        sparams.slots[1] = slots[1];
+        sparams.min_chunk_ms = pt->min_chunk_ms;
+        sparams.chunk_extend_ms = pt->chunk_extend_ms;
+        sparams.overlap_ms = pt->overlap_ms;
+        sparams.min_silence_ms = pt->min_silence_ms;
+        sparams.vad_threshold = pt->vad_threshold;
+
+        int64_t start_us = now_us();
+        int ret = whisper_stream_full(wparams, sparams);
+        int64_t elapsed_us = now_us() - start_us;
+
+        char *hyp = join_segments(&run);
+        pthread_mutex_destroy(&run.mutex);
+
+        if (ret != 0 || !hyp)
+        {
+            res->failures++;
+            free(hyp);
+            continue;
+        }
+
+        res->audio_s += (double)files[f].n_samples / WHISPER_SAMPLE_RATE;
+        res->transcribe_s += elapsed_us / 1e6;
+        for (int c = 0; c < 3; c++)
+        {
+            res->n_cuts[c] += run.n_cuts[c];
+            res->n_chunks += run.n_cuts[c];
+        }
+        res->chunk_samples_sum += run.chunk_samples_sum;
+        if (run.chunk_samples_min < res->chunk_samples_min)
+            res->chunk_samples_min = run.chunk_samples_min;
+        if (run.chunk_samples_max > res->chunk_samples_max)
+            res->chunk_samples_max = run.chunk_samples_max;
+
+        if (files[f].reference)
+        {
+            int64_t n_ref = 0;
+            int64_t errors = word_errors(hyp, files[f].reference, &n_ref);
+            if (errors >= 0)
+            {
+                res->word_errors += errors;
+                res->ref_words += n_ref;
+            }
+        }
+        free(hyp);
+    }
+}
+
+static void
+print_point(const struct sweep_point *pt, const struct point_result *res)
+{
+    printf("SWEEP: min_chunk=%d extend=%d overlap=%d min_silence=%d vad=%.2f",
+           pt->min_chunk_ms, pt->chunk_extend_ms, pt->overlap_ms,
+           pt->min_silence_ms, pt->vad_threshold);
+    if (res->failures)
+    {
+        printf(" | FAILED %d\n", res->failures);
+        return;
+    }
+
+    printf(" | RTF=%.3fx", res->audio_s > 0 ? res->transcribe_s / res->audio_s : 0.0);
+    if (res->ref_words > 0)
+        printf(" | WER=%.2f%%", res->word_errors * 100.0 / res->ref_words);
+    else
+        printf(" | WER=-");
+    printf(" | chunks=%d silence=%d forced=%d end=%d",
+           res->n_chunks, res->n_cuts[WHISPER_STREAM_CUT_SILENCE],
+           res->n_cuts[WHISPER_STREAM_CUT_FORCED], res->n_cuts[WHISPER_STREAM_CUT_END]);
+    if (res->n_chunks > 0)
+        printf(" | chunk_s=%.1f/%.1f/%.1f",
+               (double)res->chunk_samples_min / WHISPER_SAMPLE_RATE,
+               (double)res->chunk_samples_sum / res->n_chunks / WHISPER_SAMPLE_RATE,
+               (double)res->chunk_samples_max / WHISPER_SAMPLE_RATE);
+    printf("\n");
+    fflush(stdout);
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s -m model -v vad-model [options] audio files...\n", prog);
+    fprintf(stderr, "  -m, --model PATH          Whisper model\n");
+    fprintf(stderr, "  -v, --vad-model PATH      VAD model\n");
+    fprintf(stderr, "  -s, --stream N            Stream contexts (1 or 2)\n");
+    fprintf(stderr, "  -t, --threads N           Threads per context (default: 4)\n");
+    fprintf(stderr, "      --no-gpu              Disable GPU\n");
+    fprintf(stderr, "Comma separated grids:\n");
+    fprintf(stderr, "      --min-chunk MS        (default: 10000,20000,30000)\n");
+    fprintf(stderr, "      --extend MS           (default: 10000,20000,30000)\n");
+    fprintf(stderr, "      --overlap MS          (default: 300)\n");
+    fprintf(stderr, "      --min-silence MS      (default: 200,300)\n");
+    fprintf(stderr, "      --vad-threshold F     (default: 0.25,0.5)\n");
+    fprintf(stderr, "The reference transcript of foo.opus is read from foo.txt\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *model_path = NULL;
+    const char *vad_model = NULL;
+    int stream_ctx = 1;
+    int n_threads = 4;
+    bool use_gpu = true;
+    struct grid min_chunk, extend, overlap, min_silence, vad_threshold;
+
+    parse_grid("10000,20000,30000", &min_chunk);
+    parse_grid("10000,20000,30000", &extend);
+    parse_grid("300", &overlap);
+    parse_grid("200,300", &min_silence);
+    parse_grid("0.25,0.5", &vad_threshold);
+
+    enum { OPT_NO_GPU = 256, OPT_MIN_CHUNK, OPT_EXTEND, OPT_OVERLAP, OPT_MIN_SILENCE, OPT_VAD };
+    static struct option long_opts[] = {
+        {"model",         required_argument, 0, 'm'},
+        {"vad-model",     required_argument, 0, 'v'},
+        {"stream",        required_argument, 0, 's'},
+        {"threads",       required_argument, 0, 't'},
+        {"no-gpu",        no_argument,       0, OPT_NO_GPU},
+        {"min-chunk",     required_argument, 0, OPT_MIN_CHUNK},
+        {"extend",        required_argument, 0, OPT_EXTEND},
+        {"overlap",       required_argument, 0, OPT_OVERLAP},
+        {"min-silence",   required_argument, 0, OPT_MIN_SILENCE},
+        {"vad-threshold", required_argument, 0, OPT_VAD},
+        {0, 0, 0, 0}
+    };
+
+    int opt, err = 0;
+    while ((opt = getopt_long(argc, argv, "m:v:s:t:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'm': model_path = optarg; break;
+        case 'v': vad_model = optarg; break;
+        case 's': stream_ctx = atoi(optarg); break;
+        case 't': n_threads = atoi(optarg); break;
+        case OPT_NO_GPU: use_gpu = false; break;
+        case OPT_MIN_CHUNK: err |= parse_grid(optarg, &min_chunk); break;
+        case OPT_EXTEND: err |= parse_grid(optarg, &extend); break;
+        case OPT_OVERLAP: err |= parse_grid(optarg, &overlap); break;
+        case OPT_MIN_SILENCE: err |= parse_grid(optarg, &min_silence); break;
+        case OPT_VAD: err |= parse_grid(optarg, &vad_threshold); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (err || !model_path || !vad_model || optind >= argc
+        || stream_ctx < 1 || stream_ctx > 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    whisper_log_set(log_disable, NULL);
+
+    int ret = 1;
+    int n_files = argc - optind;
+    struct corpus_file *files = calloc(n_files, sizeof *files);
+    struct whisper_stream_slot slots[2] = {{0}};
+    if (!files)
+        return 1;
+
+    for (int f = 0; f < n_files; f++)
+    {
+        files[f].path = argv[optind + f];
+        files[f].samples = read_avcodec(files[f].path, &files[f].n_samples);
+        if (!files[f].samples)
+            goto cleanup;
+        files[f].reference = read_reference(files[f].path);
+        fprintf(stderr, "%s: %.1fs%s\n", files[f].path,
+                (float)files[f].n_samples / WHISPER_SAMPLE_RATE,
+                files[f].reference ? "" : ", no reference");
+    }
+
+    for (int i = 0; i < stream_ctx; i++)
+    {
+        struct whisper_context_params cparams = whisper_context_default_params();
+        /* The second context always runs on CPU, like stream_test */
+        cparams.flash_attn = cparams.use_gpu = use_gpu && i == 0;
+        slots[i].ctx = whisper_init_from_file_with_params(model_path, cparams);
+
+        struct whisper_vad_context_params vp = whisper_vad_default_context_params();
+        vp.n_threads = 1;
+        vp.use_gpu = false;
+        slots[i].vad_ctx = whisper_vad_init_from_file_with_params(vad_model, vp);
+        slots[i].num_threads = n_threads;
+
+        if (!slots[i].ctx || !slots[i].vad_ctx)
+        {
+            fprintf(stderr, "Failed to load models\n");
+            goto cleanup;
+        }
+    }
+
+    for (int a = 0; a < min_chunk.n; a++)
+    for (int b = 0; b < extend.n; b++)
+    for (int c = 0; c < overlap.n; c++)
+    for (int d = 0; d < min_silence.n; d++)
+    for (int e = 0; e < vad_threshold.n; e++)
+    {
+        struct sweep_point pt = {
+            .min_chunk_ms = (int)min_chunk.values[a],
+            .chunk_extend_ms = (int)extend.values[b],
+            .overlap_ms = (int)overlap.values[c],
+            .min_silence_ms = (int)min_silence.values[d],
+            .vad_threshold = vad_threshold.values[e],
+        };
+        if (pt.overlap_ms < 0 || pt.overlap_ms >= pt.min_chunk_ms)
+            continue;
+
+        struct point_result res;
+        run_point(&pt, slots, files, n_files, &res);
+        print_point(&pt, &res);
+    }
+    ret = 0;
+
+cleanup:
+    for (int i = 0; i < 2; i++)
+    {
+        if (slots[i].vad_ctx)
+            whisper_vad_free(slots[i].vad_ctx);
+        if (slots[i].ctx)
+            whisper_free(slots[i].ctx);
+    }
+    for (int f = 0; f < n_files; f++)
+    {
+        free(files[f].samples);
+        free(files[f].reference);
+    }
+    free(files);
+    return ret;
+}
@@ -6,6 +6,7 @@
 #include <android/asset_manager_jni.h>
 #include <android/log.h>
 #include <assert.h>
+#include <dlfcn.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -18,7 +19,7 @@
 #include "whisper.h"
 #include "stream.h"
 #include "ggml.h"
-#include "ggml-vulkan.h"
+#include "ggml-backend.h"
 
 #define UNUSED(x) (void)(x)
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
@@ -144,14 +145,18 @@ struct model_load_args
     char *vad_model_path;
     jobject asset_manager;
     bool use_gpu;
+    bool trust_gpu;             /* skip the blocklist, explicit caller opt-in */
 };
 
 struct start_args
 {
     int num_threads;
+    int gpu_threads;
     char *language;
     bool translate;
     bool live;
+    int min_chunk_ms;           /* -1 for the mode default */
+    int chunk_extend_ms;        /* -1 for the mode default */
     unsigned int session_id;
 };
 
@@ -192,7 +197,7 @@ struct whisper_jni_context
 
     bool should_shutdown;
     bool use_gpu;
-    atomic_int_fast64_t duration_samples;  /* 0 = unknown, no progress callbacks */
+    atomic_int_fast64_t duration_samples;  /* 0 = unknown, no percentage nor ETA */
     atomic_int lang_override;              /* 0 = no override, >0 = lang_id to use */
 };
 
@@ -212,6 +217,7 @@ model_load_args_init(struct model_load_args *args)
     args->vad_model_path = NULL;
     args->asset_manager = NULL;
     args->use_gpu = false;
+    args->trust_gpu = false;
 }
 
 static void
@@ -229,9 +235,12 @@ static void
 start_args_init(struct start_args *args)
 {
     args->num_threads = 0;
+    args->gpu_threads = 1;
     args->language = NULL;
     args->translate = false;
     args->live = false;
+    args->min_chunk_ms = -1;
+    args->chunk_extend_ms = -1;
     args->session_id = 0;
 }
 
@@ -383,13 +392,28 @@ asset_close(void *ctx)
     AAsset_close((AAsset *) ctx);
 }
 
+/* First GPU in the ggml registry, the one whisper picks */
+static ggml_backend_dev_t
+find_gpu_device(void)
+{
+    for (size_t i = 0; i < ggml_backend_dev_count(); i++)
+    {
+        ggml_backend_dev_t dev = ggml_backend_dev_get(i);
+        enum ggml_backend_dev_type type = ggml_backend_dev_type(dev);
+        if (type != GGML_BACKEND_DEVICE_TYPE_CPU && type != GGML_BACKEND_DEVICE_TYPE_ACCEL)
+            return dev;
+    }
+    return NULL;
+}
+
 static bool
 is_gpu_blocklisted(const char *desc)
 {
     size_t len = strlen(desc);
 
     /* Adreno 6xx-7xx series (tested until 730) cause VK_ERROR_DEVICE_LOST or
-     * fail to link some  shaders */
+     * fail to link some  shaders. Only trust_gpu, an explicit opt-in of the
+     * caller, bypasses it: the calibration never loads a blocklisted GPU. */
     if (strncmp(desc, "Adreno", 6) == 0)
     {
         return true;
@@ -504,11 +528,11 @@ load_model(struct whisper_jni_context *ctx, JNIEnv *env,
         if (args->use_gpu)
         {
             bool use_gpu = whisper_ctx_is_using_gpu(slot->ctx);
-            int vk_device_count = ggml_backend_vk_get_device_count();
-            if (use_gpu && vk_device_count > 0)
+            ggml_backend_dev_t gpu_dev = find_gpu_device();
+            if (use_gpu && gpu_dev)
             {
-                ggml_backend_vk_get_device_description(0, desc, sizeof(desc));
-                if (!is_gpu_blocklisted(desc))
+                snprintf(desc, sizeof(desc), "%s", ggml_backend_dev_description(gpu_dev));
+                if (args->trust_gpu || !is_gpu_blocklisted(desc))
                 {
                     gpu_desc = (*env)->NewStringUTF(env, desc);
                     ctx->use_gpu = true;
@@ -575,10 +599,13 @@ jni_read_callback(float *samples, int n_samples_max, void *user_data)
 }
 
 static void
-jni_segment_callback(struct whisper_context *wctx, int64_t t0, int64_t t1,
-                     const char *text, void *user_data)
+jni_segment_callback(struct whisper_context *wctx,
+                     const struct whisper_stream_segment *seg, void *user_data)
 {
     UNUSED(wctx);
+    int64_t t0 = seg->t0;
+    int64_t t1 = seg->t1;
+    const char *text = seg->text;
 
 #ifdef EXTRA_LOGS
     int64_t ms0 = t0 * 10;
@@ -598,8 +625,7 @@ jni_segment_callback(struct whisper_context *wctx, int64_t t0, int64_t t1,
     jlong start_ms = t0 * 10;
     jlong end_ms = t1 * 10;
 
-    int lang_id = whisper_full_lang_id(ctx->slots[SLOT_MAIN].ctx);
-    const char *lang_cstr = (lang_id >= 0) ? whisper_lang_str(lang_id) : NULL;
+    const char *lang_cstr = (seg->lang_id >= 0) ? whisper_lang_str(seg->lang_id) : NULL;
     jstring lang_str = lang_cstr ? (*env)->NewStringUTF(env, lang_cstr) : NULL;
 
     jstring text_str = jni_new_string_utf(env, text);
@@ -617,29 +643,38 @@ jni_segment_callback(struct whisper_context *wctx, int64_t t0, int64_t t1,
 }
 
 static void
-jni_progress_callback(int chunk_progress, int64_t samples_before,
-                      int chunk_samples, void *user_data)
+jni_progress_callback(const struct whisper_stream_progress *progress,
+                      void *user_data)
 {
     struct whisper_jni_context *ctx = user_data;
 
-    int64_t total = atomic_load(&ctx->duration_samples);
-    if (total <= 0)
-        return;
-
     JNIEnv *env = get_thread_env(ctx);
     if (!env)
         return;
 
-    int64_t samples_done = samples_before + (chunk_progress * chunk_samples) / 100;
-    int overall = (int)((samples_done * 100) / total);
-    if (overall > 100)
-        overall = 100;
+    /* -1 when the duration is unknown, processed_ms is still valid */
+    int overall = -1;
+    if (progress->samples_total > 0)
+    {
+        overall = (int)((progress->samples_done * 100) / progress->samples_total);
+        if (overall > 100)
+            overall = 100;
+    }
+    jlong processed_ms = (progress->samples_done * 1000) / WHISPER_SAMPLE_RATE;
 
     (*env)->CallVoidMethod(env, ctx->java_context,
-                           ctx->mid_on_progress, overall);
+                           ctx->mid_on_progress, overall, processed_ms,
+                           (jlong)progress->eta_ms, (jfloat)progress->speed);
     jni_check_exception(env);
 }
 
+static int64_t
+jni_duration_callback(void *user_data)
+{
+    struct whisper_jni_context *ctx = user_data;
+    return atomic_load(&ctx->duration_samples);
+}
+
 static bool
 whisper_abort_callback_impl(void *user_data)
 {
@@ -655,6 +690,25 @@ jni_language_callback(void *user_data)
     return atomic_load(&ctx->lang_override);
 }
 
+static void
+log_mem_stats(const struct whisper_stream_stats *stats, int n_slots)
+{
+    for (int i = 0; i < n_slots; i++)
+    {
+        const struct whisper_stream_mem_stats *mem = &stats->slots[i].mem;
+        LOGI("[ctx%d] max sampled memory (KiB): weights=%zu kv=%zu compute=%zu "
+             "audio=%zu tokens=%zu vad=%zu", i,
+             mem->max[WHISPER_STREAM_MEM_WEIGHTS] / 1024,
+             mem->max[WHISPER_STREAM_MEM_KV] / 1024,
+             mem->max[WHISPER_STREAM_MEM_COMPUTE] / 1024,
+             mem->max[WHISPER_STREAM_MEM_AUDIO] / 1024,
+             mem->max[WHISPER_STREAM_MEM_TOKENS] / 1024,
+             mem->max[WHISPER_STREAM_MEM_VAD] / 1024);
+    }
+    LOGI("shared max memory (KiB): audio=%zu",
+         stats->mem.max[WHISPER_STREAM_MEM_AUDIO] / 1024);
+}
+
 static void
 process_start_command(struct whisper_jni_context *ctx,
                       struct start_args *args, JNIEnv *env)
@@ -694,6 +748,8 @@ process_start_command(struct whisper_jni_context *ctx,
     sparams.segment_callback_user_data = ctx;
     sparams.progress_callback = jni_progress_callback;
     sparams.progress_callback_user_data = ctx;
+    sparams.duration_callback = jni_duration_callback;
+    sparams.duration_callback_user_data = ctx;
     sparams.language_callback = jni_language_callback;
     sparams.language_callback_user_data = ctx;
     sparams.abort_callback = whisper_abort_callback_impl;
@@ -710,17 +766,23 @@ process_start_command(struct whisper_jni_context *ctx,
         sparams.min_chunk_ms = 30000;
         sparams.chunk_extend_ms = 30000;
     }
+    if (args->min_chunk_ms >= 0)
+        sparams.min_chunk_ms = args->min_chunk_ms;
+    if (args->chunk_extend_ms >= 0)
+        sparams.chunk_extend_ms = args->chunk_extend_ms;
     sparams.slots[0] = ctx->slots[SLOT_MAIN];
-    sparams.slots[0].num_threads = ctx->use_gpu ? 1 : args->num_threads;
+    sparams.slots[0].num_threads = ctx->use_gpu ? args->gpu_threads : args->num_threads;
     sparams.slots[1] = ctx->slots[SLOT_SECOND];
     sparams.slots[1].num_threads = sparams.slots[1].ctx ? args->num_threads : 0;
+    struct whisper_stream_stats stats = {0};
+    sparams.stats = &stats;
 
     LOGI("Starting stream: ctx0=%s (%d threads), ctx1=%s (%d threads), "
-         "lang=%s, live=%d",
+         "lang=%s, live=%d, chunk=%d+%dms",
          ctx->use_gpu ? "gpu" : "cpu", sparams.slots[0].num_threads,
          sparams.slots[1].ctx ? "cpu" : "none", sparams.slots[1].num_threads,
          args->language ? args->language : "auto",
-         args->live);
+         args->live, sparams.min_chunk_ms, sparams.chunk_extend_ms);
 
     int result = whisper_stream_full(wparams, sparams);
 
@@ -728,6 +790,7 @@ process_start_command(struct whisper_jni_context *ctx,
     bool was_stopped = (ctx->start_session_id != session_after);
 
     LOGI("Stream finished: result=%d, stopped=%d", result, was_stopped);
+    log_mem_stats(&stats, sparams.slots[1].ctx ? 2 : 1);
 
     if (!was_stopped)
     {
@@ -861,7 +924,7 @@ nativeCreate(JNIEnv *env, jobject thiz)
         "(ILjava/lang/String;)V");
     CHECK_METHOD_LOOKUP(on_loaded);
 
-    ctx->mid_on_progress = (*env)->GetMethodID(env, cls, "onProgress", "(I)V");
+    ctx->mid_on_progress = (*env)->GetMethodID(env, cls, "onProgress", "(IJJF)V");
     CHECK_METHOD_LOOKUP(on_progress);
 
     ctx->mid_on_new_segment = (*env)->GetMethodID(env, cls, "onNewSegment",
@@ -923,7 +986,8 @@ nativeCreate(JNIEnv *env, jobject thiz)
 
 static void
 nativeLoadModel(JNIEnv *env, jobject thiz, jobject asset_manager,
-                jstring model_path, jstring vad_model_path, jboolean use_gpu)
+                jstring model_path, jstring vad_model_path, jboolean use_gpu,
+                jboolean trust_gpu)
 {
     struct whisper_jni_context *ctx = get_jni_context(env, thiz);
     if (!ctx)
@@ -964,6 +1028,7 @@ nativeLoadModel(JNIEnv *env, jobject thiz, jobject asset_manager,
     }
 
     args.use_gpu = use_gpu;
+    args.trust_gpu = trust_gpu;
 
     struct command_node *cmd = allocate_command_load(&args);
     if (!cmd)
@@ -974,9 +1039,9 @@ nativeLoadModel(JNIEnv *env, jobject thiz, jobject asset_manager,
         return;
     }
 
-    LOGI("Queuing model load command for: %s, VAD: %s, GPU: %s",
+    LOGI("Queuing model load command for: %s, VAD: %s, GPU: %s%s",
          args.model_path, args.vad_model_path ? args.vad_model_path : "none",
-         use_gpu ? "enabled" : "disabled");
+         use_gpu ? "enabled" : "disabled", trust_gpu ? " (trusted)" : "");
 
     pthread_mutex_lock(&ctx->mutex);
     enqueue_command_node(ctx, cmd);
@@ -1054,8 +1119,9 @@ nativeLoadSecondModel(JNIEnv *env, jobject thiz, jobject asset_manager,
 }
 
 static void
-nativeStart(JNIEnv *env, jobject thiz, jint num_threads,
-            jstring language, jboolean translate, jboolean live)
+nativeStart(JNIEnv *env, jobject thiz, jint num_threads, jint gpu_threads,
+            jstring language, jboolean translate, jboolean live,
+            jint min_chunk_ms, jint chunk_extend_ms)
 {
     struct whisper_jni_context *ctx = get_jni_context(env, thiz);
     if (!ctx)
@@ -1065,10 +1131,10 @@ nativeStart(JNIEnv *env, jobject thiz, jint num_threads,
         return;
     }
 
-    if (num_threads < 1)
+    if (num_threads < 1 || gpu_threads < 1)
     {
         (*env)->ThrowNew(env, g_class_illegal_argument,
-                         "num_threads must be >= 1");
+                         "num_threads and gpu_threads must be >= 1");
         return;
     }
 
@@ -1087,8 +1153,11 @@ nativeStart(JNIEnv *env, jobject thiz, jint num_threads,
     }
 
     args.num_threads = num_threads;
+    args.gpu_threads = gpu_threads;
     args.translate = translate;
     args.live = live;
+    args.min_chunk_ms = min_chunk_ms;
+    args.chunk_extend_ms = chunk_extend_ms;
     args.session_id = atomic_load(&ctx->session_id);
 
     struct command_node *cmd = allocate_command_start(&args);
@@ -1100,8 +1169,9 @@ nativeStart(JNIEnv *env, jobject thiz, jint num_threads,
         return;
     }
 
-    LOGI("Queuing start command: threads=%d, lang=%s, translate=%d, session=%u, live=%d",
-         num_threads, args.language ? args.language : "auto",
+    LOGI("Queuing start command: threads=%d, gpu_threads=%d, lang=%s, translate=%d, "
+         "session=%u, live=%d",
+         num_threads, gpu_threads, args.language ? args.language : "auto",
          translate, args.session_id, live);
 
     pthread_mutex_lock(&ctx->mutex);
@@ -1206,6 +1276,64 @@ nativeDestroy(JNIEnv *env, jobject thiz)
     LOGI("WhisperContext instance destroyed");
 }
 
+#ifdef GGML_BACKEND_DL
+typedef int (*backend_score_fn)(void);
+
+/* Score of a ggml CPU variant on this CPU from its hwcaps, 0 when unsupported.
+ * Bare sonames resolve in the app's linker namespace, also from inside the APK. */
+static int
+cpu_variant_score(const char *soname)
+{
+    void *handle = dlopen(soname, RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        LOGE("Failed to open %s: %s", soname, dlerror());
+        return 0;
+    }
+
+    int score = 0;
+    backend_score_fn score_fn = (backend_score_fn)dlsym(handle, "ggml_backend_score");
+    if (score_fn)
+        score = score_fn();
+    dlclose(handle);
+    return score;
+}
+
+/* ggml_backend_load_all() only scans the executable directory, which is not
+ * where an app's libraries are, so register the backend modules by name.
+ * WHISPER_CPU_VARIANTS lists the CPU variant sonames, separated by ':'. */
+static void
+load_backends(void)
+{
+    char variants[] = WHISPER_CPU_VARIANTS;
+    const char *best = NULL;
+    int best_score = 0;
+
+    char *save = NULL;
+    for (char *name = strtok_r(variants, ":", &save); name; name = strtok_r(NULL, ":", &save))
+    {
+        int score = cpu_variant_score(name);
+        if (score > best_score)
+        {
+            best = name;
+            best_score = score;
+        }
+    }
+
+    if (!best)
+        LOGE("No ggml CPU variant supports this CPU");
+    else if (!ggml_backend_load(best))
+        LOGE("Failed to load %s", best);
+    else
+        LOGI("CPU backend: %s", best);
+
+#ifdef GGML_USE_VULKAN
+    if (!ggml_backend_load("libggml-vulkan.so"))
+        LOGE("Failed to load the Vulkan backend");
+#endif
+}
+#endif
+
 JNIEXPORT jint
 JNI_OnLoad(JavaVM *vm, void *reserved)
 {
@@ -1227,12 +1355,12 @@ JNI_OnLoad(JavaVM *vm, void *reserved)
     static const JNINativeMethod whisper_context_methods[] = {
         {"nativeCreate", "()J", (void*)nativeCreate},
         {"nativeLoadModel",
-         "(Landroid/content/res/AssetManager;Ljava/lang/String;Ljava/lang/String;Z)V",
+         "(Landroid/content/res/AssetManager;Ljava/lang/String;Ljava/lang/String;ZZ)V",
          (void*)nativeLoadModel},
         {"nativeLoadSecondModel",
          "(Landroid/content/res/AssetManager;Ljava/lang/String;Ljava/lang/String;)V",
          (void*)nativeLoadSecondModel},
-        {"nativeStart", "(ILjava/lang/String;ZZ)V", (void*)nativeStart},
+        {"nativeStart", "(IILjava/lang/String;ZZII)V", (void*)nativeStart},
         {"nativeStop", "()V", (void*)nativeStop},
         {"nativeSetDuration", "(J)V", (void*)nativeSetDuration},
         {"nativeUpdateLanguage", "(Ljava/lang/String;)V", (void*)nativeUpdateLanguage},
@@ -1271,6 +1399,9 @@ JNI_OnLoad(JavaVM *vm, void *reserved)
     (*env)->DeleteLocalRef(env, whisper_context_class);
 
     whisper_log_set(whisper_android_log_callback, NULL);
+#ifdef GGML_BACKEND_DL
+    load_backends();
+#endif
 
     LOGI("JNI_OnLoad: Native methods registered successfully");
     return JNI_VERSION_1_6;
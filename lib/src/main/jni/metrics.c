@@ -0,0 +1,458 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include "metrics.h"
+#include "stream.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define METRICS_SLOTS 2
+#define METRICS_POLL_MS 250
+
+/* Phases timed per chunk, the stalls plus the two busy parts */
+enum metrics_phase
+{
+    PHASE_TURN,
+    PHASE_READ,
+    PHASE_VAD,
+    PHASE_CONTEXT,
+    PHASE_TRANSCRIBE,
+    PHASE_COUNT
+};
+
+static const char *const phase_names[PHASE_COUNT] = {
+    "turn", "read", "vad", "context", "transcribe",
+};
+
+/* Histogram upper bounds in seconds, +Inf is implicit */
+static const double buckets[] = {
+    0.01, 0.05, 0.1, 0.5, 1, 2.5, 5, 10, 30, 60,
+};
+#define N_BUCKETS (int)(sizeof(buckets) / sizeof(buckets[0]))
+
+struct histogram
+{
+    uint64_t counts[N_BUCKETS];     /* non-cumulative, summed when rendered */
+    uint64_t count;
+    double sum;
+};
+
+struct slot_metrics
+{
+    uint64_t chunks;
+    uint64_t errors;
+    double audio_s;
+    double rtf;
+    struct histogram phases[PHASE_COUNT];
+    struct whisper_stream_mem_stats mem;
+};
+
+struct metrics
+{
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    atomic_bool stop;
+
+    char *path;
+    char *tmp_path;
+    int listen_fd;                  /* -1 in file mode */
+    int interval_ms;
+
+    struct slot_metrics slots[METRICS_SLOTS];
+    struct whisper_stream_mem_stats shared_mem;
+    int queue_samples;
+    uint64_t runs;
+    uint64_t failures;
+    uint64_t aborts;
+};
+
+static void
+histogram_observe(struct histogram *h, int64_t us)
+{
+    double s = us / 1e6;
+    for (int i = 0; i < N_BUCKETS; i++)
+    {
+        if (s <= buckets[i])
+        {
+            h->counts[i]++;
+            break;
+        }
+    }
+    h->count++;
+    h->sum += s;
+}
+
+void
+metrics_chunk(const struct whisper_stream_chunk_stats *chunk, void *user_data)
+{
+    struct metrics *m = user_data;
+
+    if ((unsigned)chunk->slot >= METRICS_SLOTS)
+        return;
+
+    int64_t wall_us = 0;
+    for (int i = 0; i < WHISPER_STREAM_TIME_COUNT; i++)
+        wall_us += chunk->time_us[i];
+    double audio_s = (double)chunk->samples / WHISPER_SAMPLE_RATE;
+
+    /* transcribe_us includes the context stall */
+    int64_t transcribe_us = chunk->transcribe_us -
+                            chunk->time_us[WHISPER_STREAM_TIME_CONTEXT];
+
+    pthread_mutex_lock(&m->mutex);
+
+    struct slot_metrics *s = &m->slots[chunk->slot];
+    s->chunks++;
+    if (chunk->result != 0)
+        s->errors++;
+    s->audio_s += audio_s;
+    if (audio_s > 0)
+        s->rtf = wall_us / 1e6 / audio_s;
+
+    histogram_observe(&s->phases[PHASE_TURN], chunk->time_us[WHISPER_STREAM_TIME_TURN]);
+    histogram_observe(&s->phases[PHASE_READ], chunk->time_us[WHISPER_STREAM_TIME_READ]);
+    histogram_observe(&s->phases[PHASE_VAD], chunk->vad_us);
+    histogram_observe(&s->phases[PHASE_CONTEXT], chunk->time_us[WHISPER_STREAM_TIME_CONTEXT]);
+    histogram_observe(&s->phases[PHASE_TRANSCRIBE], transcribe_us > 0 ? transcribe_us : 0);
+
+    s->mem = chunk->mem;
+    m->queue_samples = chunk->queued_samples;
+
+    pthread_mutex_unlock(&m->mutex);
+}
+
+void
+metrics_finish(struct metrics *m, const struct whisper_stream_stats *stats,
+               int result, bool aborted)
+{
+    pthread_mutex_lock(&m->mutex);
+
+    m->runs++;
+    if (aborted)
+        m->aborts++;
+    else if (result != 0)
+        m->failures++;
+
+    if (stats)
+    {
+        for (int i = 0; i < METRICS_SLOTS; i++)
+        {
+            if (stats->slots[i].n_chunks > 0)
+                m->slots[i].mem = stats->slots[i].mem;
+        }
+        m->shared_mem = stats->mem;
+    }
+    m->queue_samples = 0;
+
+    pthread_mutex_unlock(&m->mutex);
+}
+
+static void
+render_mem(FILE *f, bool max, const char *slot,
+           const struct whisper_stream_mem_stats *mem)
+{
+    for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+    {
+        fprintf(f, "whisper_stream_%s{slot=\"%s\",class=\"%s\"} %zu\n",
+                max ? "memory_max_bytes" : "memory_bytes",
+                slot, whisper_stream_mem_name(c),
+                max ? mem->max[c] : mem->cur[c]);
+    }
+}
+
+static void
+render_header(FILE *f, const char *name, const char *type, const char *help)
+{
+    fprintf(f, "# HELP whisper_stream_%s %s\n", name, help);
+    fprintf(f, "# TYPE whisper_stream_%s %s\n", name, type);
+}
+
+/* Returns a malloc()ed buffer, NULL on error */
+static char *
+render(struct metrics *m, size_t *len)
+{
+    char *buf = NULL;
+    FILE *f = open_memstream(&buf, len);
+    if (!f)
+        return NULL;
+
+    pthread_mutex_lock(&m->mutex);
+
+    render_header(f, "runs_total", "counter", "Streams finished.");
+    fprintf(f, "whisper_stream_runs_total %llu\n", (unsigned long long)m->runs);
+    render_header(f, "failures_total", "counter", "Streams failed, aborts excluded.");
+    fprintf(f, "whisper_stream_failures_total %llu\n", (unsigned long long)m->failures);
+    render_header(f, "aborts_total", "counter", "Streams aborted.");
+    fprintf(f, "whisper_stream_aborts_total %llu\n", (unsigned long long)m->aborts);
+    render_header(f, "queue_samples", "gauge", "Samples left in the read buffer.");
+    fprintf(f, "whisper_stream_queue_samples %d\n", m->queue_samples);
+
+    render_header(f, "chunks_total", "counter", "Chunks transcribed.");
+    for (int i = 0; i < METRICS_SLOTS; i++)
+        fprintf(f, "whisper_stream_chunks_total{slot=\"%d\"} %llu\n",
+                i, (unsigned long long)m->slots[i].chunks);
+    render_header(f, "chunk_errors_total", "counter", "Chunks whisper_full() failed on.");
+    for (int i = 0; i < METRICS_SLOTS; i++)
+        fprintf(f, "whisper_stream_chunk_errors_total{slot=\"%d\"} %llu\n",
+                i, (unsigned long long)m->slots[i].errors);
+    render_header(f, "audio_seconds_total", "counter", "Audio transcribed, overlap excluded.");
+    for (int i = 0; i < METRICS_SLOTS; i++)
+        fprintf(f, "whisper_stream_audio_seconds_total{slot=\"%d\"} %.3f\n",
+                i, m->slots[i].audio_s);
+    render_header(f, "rtf", "gauge", "Chunk time / chunk audio of the last chunk.");
+    for (int i = 0; i < METRICS_SLOTS; i++)
+        fprintf(f, "whisper_stream_rtf{slot=\"%d\"} %.4f\n", i, m->slots[i].rtf);
+
+    render_header(f, "phase_seconds", "histogram", "Time per chunk phase.");
+    for (int i = 0; i < METRICS_SLOTS; i++)
+    {
+        for (int p = 0; p < PHASE_COUNT; p++)
+        {
+            const struct histogram *h = &m->slots[i].phases[p];
+            uint64_t cum = 0;
+            for (int b = 0; b < N_BUCKETS; b++)
+            {
+                cum += h->counts[b];
+                fprintf(f, "whisper_stream_phase_seconds_bucket{slot=\"%d\",phase=\"%s\",le=\"%g\"} %llu\n",
+                        i, phase_names[p], buckets[b], (unsigned long long)cum);
+            }
+            fprintf(f, "whisper_stream_phase_seconds_bucket{slot=\"%d\",phase=\"%s\",le=\"+Inf\"} %llu\n",
+                    i, phase_names[p], (unsigned long long)h->count);
+            fprintf(f, "whisper_stream_phase_seconds_sum{slot=\"%d\",phase=\"%s\"} %.6f\n",
+                    i, phase_names[p], h->sum);
+            fprintf(f, "whisper_stream_phase_seconds_count{slot=\"%d\",phase=\"%s\"} %llu\n",
+                    i, phase_names[p], (unsigned long long)h->count);
+        }
+    }
+
+    for (int max = 0; max < 2; max++)
+    {
+        render_header(f, max ? "memory_max_bytes" : "memory_bytes", "gauge",
+                      max ? "Largest value sampled per class, once per chunk for whisper and VAD."
+                          : "Bytes allocated per class.");
+        for (int i = 0; i < METRICS_SLOTS; i++)
+        {
+            char slot[16];
+            snprintf(slot, sizeof slot, "%d", i);
+            render_mem(f, max, slot, &m->slots[i].mem);
+        }
+        render_mem(f, max, "shared", &m->shared_mem);
+    }
+
+    pthread_mutex_unlock(&m->mutex);
+
+    if (fclose(f) != 0)
+    {
+        free(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+static int
+write_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* Rewrite through a temporary file so readers never see a partial file */
+static void
+write_file(struct metrics *m)
+{
+    size_t len;
+    char *buf = render(m, &len);
+    if (!buf)
+        return;
+
+    FILE *f = fopen(m->tmp_path, "w");
+    if (f)
+    {
+        bool ok = fwrite(buf, 1, len, f) == len;
+        if (fclose(f) == 0 && ok)
+            rename(m->tmp_path, m->path);
+        else
+            unlink(m->tmp_path);
+    }
+    free(buf);
+}
+
+/* Any request gets the metrics, there is nothing else to serve */
+static void
+serve_client(struct metrics *m, int fd)
+{
+    char req[1024];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    if (poll(&pfd, 1, METRICS_POLL_MS) > 0)
+        (void)!read(fd, req, sizeof req);
+
+    size_t len;
+    char *buf = render(m, &len);
+    if (!buf)
+        return;
+
+    char hdr[128];
+    int hdr_len = snprintf(hdr, sizeof hdr,
+                           "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: %zu\r\n\r\n", len);
+    if (write_all(fd, hdr, hdr_len) == 0)
+        write_all(fd, buf, len);
+    free(buf);
+}
+
+static void *
+metrics_thread_func(void *arg)
+{
+    struct metrics *m = arg;
+    struct timespec last;
+    clock_gettime(CLOCK_MONOTONIC, &last);
+
+    while (!atomic_load(&m->stop))
+    {
+        if (m->listen_fd >= 0)
+        {
+            struct pollfd pfd = { .fd = m->listen_fd, .events = POLLIN };
+            if (poll(&pfd, 1, METRICS_POLL_MS) <= 0)
+                continue;
+            int fd = accept(m->listen_fd, NULL, NULL);
+            if (fd < 0)
+                continue;
+            serve_client(m, fd);
+            close(fd);
+            continue;
+        }
+
+        struct timespec ts = { 0, METRICS_POLL_MS * 1000000L };
+        nanosleep(&ts, NULL);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t elapsed_ms = (now.tv_sec - last.tv_sec) * 1000 +
+                             (now.tv_nsec - last.tv_nsec) / 1000000;
+        if (elapsed_ms >= m->interval_ms)
+        {
+            write_file(m);
+            last = now;
+        }
+    }
+    return NULL;
+}
+
+static int
+open_socket(const char *path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof addr.sun_path)
+    {
+        fprintf(stderr, "metrics: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof addr) < 0 || listen(fd, 4) < 0)
+    {
+        fprintf(stderr, "metrics: failed to listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct metrics *
+metrics_create(const char *target, int interval_ms)
+{
+    struct metrics *m = calloc(1, sizeof *m);
+    if (!m)
+        return NULL;
+
+    m->listen_fd = -1;
+    m->interval_ms = interval_ms > 0 ? interval_ms : 5000;
+    pthread_mutex_init(&m->mutex, NULL);
+
+    if (strncmp(target, "unix:", 5) == 0)
+    {
+        m->path = strdup(target + 5);
+        if (!m->path || (m->listen_fd = open_socket(m->path)) < 0)
+            goto fail;
+    }
+    else
+    {
+        size_t len = strlen(target) + sizeof ".tmp";
+        m->path = strdup(target);
+        m->tmp_path = malloc(len);
+        if (!m->path || !m->tmp_path)
+            goto fail;
+        snprintf(m->tmp_path, len, "%s.tmp", target);
+        write_file(m);
+    }
+
+    if (pthread_create(&m->thread, NULL, metrics_thread_func, m) != 0)
+    {
+        if (m->listen_fd >= 0)
+        {
+            close(m->listen_fd);
+            unlink(m->path);
+        }
+        goto fail;
+    }
+    return m;
+
+fail:
+    pthread_mutex_destroy(&m->mutex);
+    free(m->tmp_path);
+    free(m->path);
+    free(m);
+    return NULL;
+}
+
+void
+metrics_destroy(struct metrics *m)
+{
+    if (!m)
+        return;
+
+    atomic_store(&m->stop, true);
+    pthread_join(m->thread, NULL);
+
+    if (m->listen_fd >= 0)
+    {
+        close(m->listen_fd);
+        unlink(m->path);
+    }
+    else
+    {
+        write_file(m);
+    }
+
+    pthread_mutex_destroy(&m->mutex);
+    free(m->tmp_path);
+    free(m->path);
+    free(m);
+}
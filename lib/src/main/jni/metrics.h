@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include <stdbool.h>
+
+struct whisper_stream_chunk_stats;
+struct whisper_stream_stats;
+
+struct metrics;
+
+/* Expose metrics in Prometheus text format.
+ * target is either a file path, rewritten every interval_ms, or
+ * "unix:PATH" to serve HTTP scrapes on a Unix socket.
+ * Returns NULL on error. */
+struct metrics *
+metrics_create(const char *target, int interval_ms);
+
+/* Account one chunk, usable as whisper_stream_chunk_callback */
+void
+metrics_chunk(const struct whisper_stream_chunk_stats *chunk, void *user_data);
+
+/* Account a finished stream */
+void
+metrics_finish(struct metrics *m, const struct whisper_stream_stats *stats,
+               int result, bool aborted);
+
+/* Write the file a last time and stop serving */
+void
+metrics_destroy(struct metrics *m);
@@ -0,0 +1,557 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Microbenchmarks for the per chunk helpers of stream.c: the chunk boundary
+ * search over VAD segments, the read buffer handoff and the sample
+ * conversions. stream.c is included to reach its static functions, the VAD
+ * timelines come from the mock whisper backend. */
+
+#include "stream.c"
+
+#include "mock_whisper.h"
+
+#include <getopt.h>
+
+#define N_TIMELINES 64
+#define N_GAPS 1024
+
+/* Keeps results alive without affecting the timed loops */
+static volatile int64_t sink;
+
+typedef void (*bench_fn)(void *arg, int64_t iters);
+
+/* Speech and silence lengths of the synthetic VAD timelines */
+struct vad_profile
+{
+    const char *name;
+    int speech_ms;
+    int silence_ms;
+};
+
+static const struct vad_profile profiles[] = {
+    { "sparse",    8000, 1200 },
+    { "speech",    3000,  400 },
+    { "dense",     1200,  350 },
+    /* pauses shorter than min_silence_ms, every gap is scanned */
+    { "no-gap",    3000,  200 },
+};
+
+/* min_chunk_ms and chunk_extend_ms, the default and a low-latency live mode */
+struct chunk_layout
+{
+    const char *name;
+    int min_chunk_ms;
+    int chunk_extend_ms;
+};
+
+static const struct chunk_layout layouts[] = {
+    { "default", 30000, 20000 },
+    { "live",     2000,  2000 },
+};
+
+struct boundary_arg
+{
+    struct thread_ctx tctx;
+    struct common_ctx cctx;
+    struct whisper_vad_segments *segs[N_TIMELINES];
+    int vad_offset;
+    int available;
+};
+
+struct gap_arg
+{
+    int64_t gaps[N_GAPS][2];
+    int64_t range_start_cs;
+    int64_t range_end_cs;
+    int min_silence_ms;
+};
+
+struct handoff_arg
+{
+    struct common_ctx cctx;
+    struct thread_ctx tctx;
+    struct chunk_info ci;
+};
+
+struct convert_arg
+{
+    int16_t *pcm;
+    float *out;
+    int n;          /* frames */
+};
+
+static int64_t
+now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int
+cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Grows the iteration count to min_ms per run, then returns the median and
+ * minimum of reps runs in ns per iteration */
+static void
+measure(bench_fn fn, void *arg, int min_ms, int reps, double *median, double *best)
+{
+    int64_t iters = 1;
+    for (;;)
+    {
+        int64_t t0 = now_ns();
+        fn(arg, iters);
+        int64_t ns = now_ns() - t0;
+        if (ns >= (int64_t)min_ms * 1000000 || iters >= INT64_MAX / 2)
+            break;
+        /* Aim a bit past min_ms to avoid another doubling */
+        int64_t next = ns > 0 ? iters * min_ms * 1200000 / ns : iters * 2;
+        iters = next > iters * 2 ? next : iters * 2;
+    }
+
+    double *runs = malloc(reps * sizeof *runs);
+    if (!runs)
+    {
+        *median = *best = 0;
+        return;
+    }
+    for (int r = 0; r < reps; r++)
+    {
+        int64_t t0 = now_ns();
+        fn(arg, iters);
+        runs[r] = (double)(now_ns() - t0) / iters;
+    }
+    qsort(runs, reps, sizeof *runs, cmp_double);
+    *median = runs[reps / 2];
+    *best = runs[0];
+    free(runs);
+}
+
+static void
+report(const char *name, double median, double best, double bytes_per_iter)
+{
+    printf("MICRO: %-36s | %10.1f ns/op | min=%10.1f ns/op", name, median, best);
+    if (bytes_per_iter > 0 && median > 0)
+        printf(" | %.2f GB/s", bytes_per_iter / median);
+    printf("\n");
+    fflush(stdout);
+}
+
+/* check_gap */
+
+static void
+bench_check_gap(void *p, int64_t iters)
+{
+    struct gap_arg *a = p;
+    int64_t acc = 0;
+    for (int64_t i = 0; i < iters; i++)
+    {
+        const int64_t *g = a->gaps[i & (N_GAPS - 1)];
+        acc += check_gap(g[0], g[1], a->range_start_cs, a->range_end_cs,
+                         a->min_silence_ms);
+    }
+    sink = acc;
+}
+
+static void
+init_gaps(struct gap_arg *a, const struct chunk_layout *layout, int min_silence_ms)
+{
+    int64_t max_cs = (layout->min_chunk_ms + layout->chunk_extend_ms) / 10;
+    a->range_start_cs = layout->min_chunk_ms / 10;
+    a->range_end_cs = max_cs;
+    a->min_silence_ms = min_silence_ms;
+    for (int i = 0; i < N_GAPS; i++)
+    {
+        int64_t start = rand() % max_cs;
+        a->gaps[i][0] = start;
+        a->gaps[i][1] = start + rand() % 100;
+    }
+}
+
+/* find_silence_in_segments and find_chunk_boundary */
+
+static void
+bench_find_silence(void *p, int64_t iters)
+{
+    struct boundary_arg *a = p;
+    struct common_ctx *cctx = &a->cctx;
+    int search_end = MIN(cctx->max_chunk_samples, a->available);
+    int64_t acc = 0;
+    for (int64_t i = 0; i < iters; i++)
+    {
+        acc += find_silence_in_segments(a->segs[i & (N_TIMELINES - 1)],
+                                        cctx->min_chunk_samples, search_end,
+                                        cctx->min_silence_ms, a->vad_offset);
+    }
+    sink = acc;
+}
+
+static void
+bench_find_boundary(void *p, int64_t iters)
+{
+    struct boundary_arg *a = p;
+    int64_t acc = 0;
+    for (int64_t i = 0; i < iters; i++)
+    {
+        int silence_found;
+        acc += find_chunk_boundary(&a->tctx, a->available,
+                                   a->segs[i & (N_TIMELINES - 1)], a->vad_offset,
+                                   &silence_found);
+        acc += silence_found;
+    }
+    sink = acc;
+}
+
+/* Builds N_TIMELINES timelines with speech and silence lengths jittered by
+ * up to 25% over the VAD window of process_one_chunk() */
+static int
+init_boundary(struct boundary_arg *a, const struct chunk_layout *layout,
+              const struct vad_profile *profile, int min_silence_ms)
+{
+    struct mock_whisper_params mp = mock_whisper_default_params();
+    struct whisper_vad_context_params vparams = whisper_vad_default_context_params();
+
+    memset(a, 0, sizeof *a);
+    a->cctx.min_chunk_samples = layout->min_chunk_ms * (WHISPER_SAMPLE_RATE / 1000);
+    a->cctx.max_chunk_samples = a->cctx.min_chunk_samples
+                              + layout->chunk_extend_ms * (WHISPER_SAMPLE_RATE / 1000);
+    a->cctx.min_silence_ms = min_silence_ms;
+    a->tctx.cctx = &a->cctx;
+    a->available = a->cctx.max_chunk_samples;
+
+    int margin = 5 * WHISPER_SAMPLE_RATE;
+    a->vad_offset = a->cctx.min_chunk_samples > margin ? a->cctx.min_chunk_samples - margin : 0;
+    int vad_len = a->cctx.max_chunk_samples - a->vad_offset;
+    float *audio = calloc(vad_len, sizeof *audio);
+    if (!audio)
+        return -1;
+
+    int ret = 0;
+    mp.vad_ms_per_s = 0;
+    for (int i = 0; i < N_TIMELINES && ret == 0; i++)
+    {
+        mp.speech_ms = profile->speech_ms * (75 + rand() % 51) / 100;
+        mp.silence_ms = profile->silence_ms * (75 + rand() % 51) / 100;
+        if (mp.silence_ms >= min_silence_ms && profile->silence_ms < min_silence_ms)
+            mp.silence_ms = min_silence_ms - 10;
+        mock_whisper_set_params(&mp);
+
+        struct whisper_vad_context *vctx =
+            whisper_vad_init_from_file_with_params("mock", vparams);
+        if (!vctx)
+        {
+            ret = -1;
+            break;
+        }
+        whisper_vad_detect_speech(vctx, audio, vad_len);
+        a->segs[i] = whisper_vad_segments_from_probs(vctx, whisper_vad_default_params());
+        whisper_vad_free(vctx);
+        if (!a->segs[i])
+            ret = -1;
+    }
+
+    free(audio);
+    return ret;
+}
+
+static void
+cleanup_boundary(struct boundary_arg *a)
+{
+    for (int i = 0; i < N_TIMELINES; i++)
+    {
+        if (a->segs[i])
+            whisper_vad_free_segments(a->segs[i]);
+    }
+}
+
+static double
+mean_segments(const struct boundary_arg *a)
+{
+    double n = 0;
+    for (int i = 0; i < N_TIMELINES; i++)
+        n += whisper_vad_segments_n_segments(a->segs[i]);
+    return n / N_TIMELINES;
+}
+
+/* handoff_to_next */
+
+static void
+bench_handoff(void *p, int64_t iters)
+{
+    struct handoff_arg *a = p;
+    struct common_ctx *cctx = &a->cctx;
+    bool single = cctx->single_thread;
+    int64_t acc = 0;
+    for (int64_t i = 0; i < iters; i++)
+    {
+        /* A full buffer, as after fill_read_buffer() */
+        cctx->read_buffer_len = cctx->buffer_size;
+        cctx->eof = false;
+        /* Each mode's instance, as process_one_chunk() inlines it */
+        acc += single ? handoff_to_next(&a->tctx, true, &a->ci, 0, 1, false)
+                      : handoff_to_next(&a->tctx, false, &a->ci, 0, 1, false);
+    }
+    sink = acc;
+}
+
+static int
+init_handoff(struct handoff_arg *a, const struct chunk_layout *layout, bool single_thread)
+{
+    struct whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    struct whisper_stream_params sparams = whisper_stream_default_params();
+    int ms = WHISPER_SAMPLE_RATE / 1000;
+    int min_chunk = layout->min_chunk_ms * ms;
+    int max_chunk = min_chunk + layout->chunk_extend_ms * ms;
+    int overlap = sparams.overlap_ms * ms;
+
+    memset(a, 0, sizeof *a);
+    if (init_common_ctx(&a->cctx, params, &sparams, 0, overlap, min_chunk,
+                        max_chunk, single_thread) < 0)
+        return -1;
+    /* The slot buffer the read buffer is swapped with */
+    a->tctx.cctx = &a->cctx;
+    a->tctx.buffer = malloc(a->cctx.buffer_size * sizeof *a->tctx.buffer);
+    if (!a->tctx.buffer)
+    {
+        cleanup_common_ctx(&a->cctx);
+        return -1;
+    }
+    for (int i = 0; i < a->cctx.buffer_size; i++)
+        a->cctx.read_buffer[i] = a->tctx.buffer[i] = (float)i;
+
+    /* Cut at the middle of the search range, the usual silence cut */
+    int boundary = min_chunk + (max_chunk - min_chunk) / 2;
+    a->ci = make_chunk_info(&a->cctx, boundary, max_chunk, overlap, 0, false);
+    return 0;
+}
+
+static double
+handoff_bytes(const struct handoff_arg *a)
+{
+    int keep_start = a->ci.actual_chunk_samples - a->cctx.overlap_samples;
+    return (double)(a->cctx.buffer_size - keep_start) * sizeof(float);
+}
+
+/* Sample conversions, as done before audio reaches stream.c */
+
+/* LiveAudioProvider and FileAudioProvider */
+static void
+bench_pcm16_div(void *p, int64_t iters)
+{
+    struct convert_arg *a = p;
+    for (int64_t it = 0; it < iters; it++)
+    {
+        for (int i = 0; i < a->n; i++)
+            a->out[i] = a->pcm[i] / 32767.0f;
+    }
+    sink = (int64_t)a->out[iters % a->n];
+}
+
+static void
+bench_pcm16_mul(void *p, int64_t iters)
+{
+    struct convert_arg *a = p;
+    const float scale = 1.0f / 32767.0f;
+    for (int64_t it = 0; it < iters; it++)
+    {
+        for (int i = 0; i < a->n; i++)
+            a->out[i] = a->pcm[i] * scale;
+    }
+    sink = (int64_t)a->out[iters % a->n];
+}
+
+/* FileAudioProvider stereo downmix */
+static void
+bench_pcm16_stereo(void *p, int64_t iters)
+{
+    struct convert_arg *a = p;
+    for (int64_t it = 0; it < iters; it++)
+    {
+        for (int i = 0; i < a->n; i++)
+            a->out[i] = (a->pcm[i * 2] + a->pcm[i * 2 + 1]) / 32767.0f / 2.0f;
+    }
+    sink = (int64_t)a->out[iters % a->n];
+}
+
+/* Centisecond and sample conversions of find_silence_in_segments() and
+ * make_chunk_info() */
+static void
+bench_time_convert(void *p, int64_t iters)
+{
+    struct convert_arg *a = p;
+    int64_t acc = 0;
+    for (int64_t it = 0; it < iters; it++)
+    {
+        int64_t samples = a->pcm[it & 1023] * 977 + it;
+        int64_t cs = samples * 100 / WHISPER_SAMPLE_RATE;
+        acc += cs * WHISPER_SAMPLE_RATE / 100;
+    }
+    sink = acc;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -f, --filter S        Only run benchmarks whose name contains S\n");
+    fprintf(stderr, "  -t, --min-time MS     Minimum time per run (default: 50)\n");
+    fprintf(stderr, "  -r, --reps N          Runs per benchmark, the median is reported (default: 5)\n");
+    fprintf(stderr, "      --min-silence MS  min_silence_ms of the boundary search (default: 300)\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *filter = NULL;
+    int min_ms = 50;
+    int reps = 5;
+    int min_silence_ms = whisper_stream_default_params().min_silence_ms;
+
+    enum { OPT_MIN_SILENCE = 256 };
+    static struct option long_opts[] = {
+        {"filter",      required_argument, 0, 'f'},
+        {"min-time",    required_argument, 0, 't'},
+        {"reps",        required_argument, 0, 'r'},
+        {"min-silence", required_argument, 0, OPT_MIN_SILENCE},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:t:r:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': filter = optarg; break;
+        case 't': min_ms = atoi(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case OPT_MIN_SILENCE: min_silence_ms = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (min_ms < 1 || reps < 1 || min_silence_ms < 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(1);
+    char name[64];
+    double median, best;
+    int n_layouts = sizeof layouts / sizeof *layouts;
+    int n_profiles = sizeof profiles / sizeof *profiles;
+
+    for (int l = 0; l < n_layouts; l++)
+    {
+        const struct chunk_layout *layout = &layouts[l];
+
+        snprintf(name, sizeof name, "check_gap/%s", layout->name);
+        if (!filter || strstr(name, filter))
+        {
+            struct gap_arg gaps;
+            init_gaps(&gaps, layout, min_silence_ms);
+            measure(bench_check_gap, &gaps, min_ms, reps, &median, &best);
+            report(name, median, best, 0);
+        }
+
+        for (int p = 0; p < n_profiles; p++)
+        {
+            static struct boundary_arg boundary;
+            char silence_name[64], boundary_name[64];
+            snprintf(silence_name, sizeof silence_name, "find_silence/%s/%s",
+                     layout->name, profiles[p].name);
+            snprintf(boundary_name, sizeof boundary_name, "find_chunk_boundary/%s/%s",
+                     layout->name, profiles[p].name);
+            bool run_silence = !filter || strstr(silence_name, filter);
+            bool run_boundary = !filter || strstr(boundary_name, filter);
+            if (!run_silence && !run_boundary)
+                continue;
+
+            if (init_boundary(&boundary, layout, &profiles[p], min_silence_ms) < 0)
+            {
+                fprintf(stderr, "Failed to build VAD timelines\n");
+                cleanup_boundary(&boundary);
+                return 1;
+            }
+            fprintf(stderr, "%s/%s: %.1f segments per window\n", layout->name,
+                    profiles[p].name, mean_segments(&boundary));
+            if (run_silence)
+            {
+                measure(bench_find_silence, &boundary, min_ms, reps, &median, &best);
+                report(silence_name, median, best, 0);
+            }
+            if (run_boundary)
+            {
+                measure(bench_find_boundary, &boundary, min_ms, reps, &median, &best);
+                report(boundary_name, median, best, 0);
+            }
+            cleanup_boundary(&boundary);
+        }
+
+        for (int single = 1; single >= 0; single--)
+        {
+            snprintf(name, sizeof name, "handoff/%s/%s", layout->name,
+                     single ? "single" : "dual");
+            if (filter && !strstr(name, filter))
+                continue;
+
+            struct handoff_arg handoff;
+            if (init_handoff(&handoff, layout, single) < 0)
+            {
+                fprintf(stderr, "Failed to allocate the read buffer\n");
+                return 1;
+            }
+            measure(bench_handoff, &handoff, min_ms, reps, &median, &best);
+            report(name, median, best, handoff_bytes(&handoff));
+            cleanup_common_ctx(&handoff.cctx);
+            free(handoff.tctx.buffer);
+        }
+    }
+
+    /* One second of audio per iteration */
+    struct convert_arg conv;
+    conv.n = WHISPER_SAMPLE_RATE;
+    conv.pcm = malloc(conv.n * 2 * sizeof *conv.pcm);
+    conv.out = malloc(conv.n * sizeof *conv.out);
+    if (!conv.pcm || !conv.out)
+    {
+        free(conv.pcm);
+        free(conv.out);
+        return 1;
+    }
+    for (int i = 0; i < conv.n * 2; i++)
+        conv.pcm[i] = (int16_t)(rand() - RAND_MAX / 2);
+
+    static const struct
+    {
+        const char *name;
+        bench_fn fn;
+        int channels;
+    } conversions[] = {
+        { "pcm16_to_float/div",    bench_pcm16_div,    1 },
+        { "pcm16_to_float/mul",    bench_pcm16_mul,    1 },
+        { "pcm16_to_float/stereo", bench_pcm16_stereo, 2 },
+    };
+    for (size_t c = 0; c < sizeof conversions / sizeof *conversions; c++)
+    {
+        if (filter && !strstr(conversions[c].name, filter))
+            continue;
+        measure(conversions[c].fn, &conv, min_ms, reps, &median, &best);
+        report(conversions[c].name, median, best,
+               (double)conv.n * conversions[c].channels * sizeof *conv.pcm);
+    }
+    if (!filter || strstr("samples_to_cs", filter))
+    {
+        measure(bench_time_convert, &conv, min_ms, reps, &median, &best);
+        report("samples_to_cs", median, best, 0);
+    }
+
+    free(conv.pcm);
+    free(conv.out);
+    return 0;
+}
@@ -0,0 +1,445 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include "mock_whisper.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MOCK_TEXT_CTX 448
+#define MOCK_SLEEP_SLICE_MS 5
+
+struct mock_segment
+{
+    int64_t t0;
+    int64_t t1;
+    char text[32];
+};
+
+struct whisper_context
+{
+    struct mock_whisper_params params;
+    unsigned rng;
+    int lang_id;
+
+    struct mock_segment *segs;
+    int n_segs;
+    int cap_segs;
+};
+
+struct whisper_vad_context
+{
+    struct mock_whisper_params params;
+    int n_samples;
+};
+
+struct whisper_vad_segments
+{
+    int n;
+    int64_t (*t)[2];
+};
+
+static struct mock_whisper_params g_params = {
+    .fixed_ms = 20,
+    .rtf = 0.01f,
+    .sigma = 0.2f,
+    .encode_share = 0.4f,
+    .vad_ms_per_s = 0.1f,
+    .speech_ms = 4000,
+    .silence_ms = 600,
+    .segment_ms = 3000,
+    .prompt_tokens = 64,
+    .seed = 1,
+};
+
+static atomic_uint g_n_ctx;
+static atomic_llong g_busy_us;
+
+struct mock_whisper_params
+mock_whisper_default_params(void)
+{
+    return g_params;
+}
+
+void
+mock_whisper_set_params(const struct mock_whisper_params *params)
+{
+    g_params = *params;
+}
+
+int64_t
+mock_whisper_busy_us(void)
+{
+    return atomic_load(&g_busy_us);
+}
+
+static void
+sleep_us(int64_t us)
+{
+    if (us <= 0)
+        return;
+    struct timespec ts = { us / 1000000, (us % 1000000) * 1000 };
+    while (nanosleep(&ts, &ts) != 0)
+        ;
+    atomic_fetch_add(&g_busy_us, us);
+}
+
+/* Sleeps in slices so that aborts are noticed, returns false on abort */
+static bool
+work_us(int64_t us, ggml_abort_callback abort_cb, void *abort_data)
+{
+    while (us > 0)
+    {
+        if (abort_cb && abort_cb(abort_data))
+            return false;
+        int64_t slice = us < MOCK_SLEEP_SLICE_MS * 1000 ? us : MOCK_SLEEP_SLICE_MS * 1000;
+        sleep_us(slice);
+        us -= slice;
+    }
+    return true;
+}
+
+/* Log-normal factor with mean 1 */
+static double
+latency_factor(struct whisper_context *ctx)
+{
+    float sigma = ctx->params.sigma;
+    if (sigma <= 0)
+        return 1.0;
+
+    double u1 = (rand_r(&ctx->rng) + 1.0) / ((double)RAND_MAX + 2.0);
+    double u2 = (rand_r(&ctx->rng) + 1.0) / ((double)RAND_MAX + 2.0);
+    double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    return exp(sigma * z - sigma * sigma / 2.0);
+}
+
+struct whisper_context_params
+whisper_context_default_params(void)
+{
+    struct whisper_context_params params;
+    memset(&params, 0, sizeof params);
+    return params;
+}
+
+struct whisper_context *
+whisper_init_from_file_with_params(const char *path, struct whisper_context_params params)
+{
+    (void)path;
+    (void)params;
+    struct whisper_context *ctx = calloc(1, sizeof *ctx);
+    if (!ctx)
+        return NULL;
+    ctx->params = g_params;
+    ctx->rng = g_params.seed + atomic_fetch_add(&g_n_ctx, 1);
+    ctx->lang_id = 0;
+    return ctx;
+}
+
+void
+whisper_free(struct whisper_context *ctx)
+{
+    if (!ctx)
+        return;
+    free(ctx->segs);
+    free(ctx);
+}
+
+struct whisper_full_params
+whisper_full_default_params(enum whisper_sampling_strategy strategy)
+{
+    (void)strategy;
+    struct whisper_full_params params;
+    memset(&params, 0, sizeof params);
+    params.n_threads = 4;
+    params.language = "en";
+    params.vad_params = whisper_vad_default_params();
+    return params;
+}
+
+static int
+add_segment(struct whisper_context *ctx, int64_t t0, int64_t t1)
+{
+    if (ctx->n_segs == ctx->cap_segs)
+    {
+        int cap = ctx->cap_segs ? ctx->cap_segs * 2 : 16;
+        struct mock_segment *tmp = realloc(ctx->segs, cap * sizeof *tmp);
+        if (!tmp)
+            return -1;
+        ctx->segs = tmp;
+        ctx->cap_segs = cap;
+    }
+    struct mock_segment *seg = &ctx->segs[ctx->n_segs++];
+    seg->t0 = t0;
+    seg->t1 = t1;
+    snprintf(seg->text, sizeof seg->text, " segment %lld", (long long)t0);
+    return 0;
+}
+
+/* Encoder share, context callback, then decoder share emitting segments
+ * evenly - the same order as the patched whisper_full() */
+int
+whisper_full(struct whisper_context *ctx, struct whisper_full_params params,
+             const float *samples, int n_samples)
+{
+    (void)samples;
+    ctx->n_segs = 0;
+
+    int64_t start_ms = params.offset_ms;
+    int64_t end_ms = (int64_t)n_samples * 1000 / WHISPER_SAMPLE_RATE;
+    if (params.duration_ms > 0 && start_ms + params.duration_ms < end_ms)
+        end_ms = start_ms + params.duration_ms;
+    int64_t audio_ms = end_ms > start_ms ? end_ms - start_ms : 0;
+
+    int64_t total_us = (int64_t)((ctx->params.fixed_ms + ctx->params.rtf * audio_ms)
+                                 * 1000.0 * latency_factor(ctx));
+    int64_t encode_us = (int64_t)(total_us * ctx->params.encode_share);
+    int64_t decode_us = total_us - encode_us;
+
+    if (!work_us(encode_us, params.abort_callback, params.abort_callback_user_data))
+        return -6;
+
+    if (params.context_callback)
+    {
+        whisper_token tokens[MOCK_TEXT_CTX];
+        int lang_id = -1;
+        params.context_callback(ctx, NULL, tokens, MOCK_TEXT_CTX / 2, &lang_id,
+                                params.context_callback_user_data);
+        if (lang_id >= 0)
+            ctx->lang_id = lang_id;
+    }
+
+    int seg_ms = ctx->params.segment_ms > 0 ? ctx->params.segment_ms : 3000;
+    int n_segs = (int)((audio_ms + seg_ms - 1) / seg_ms);
+    if (n_segs < 1)
+        n_segs = 1;
+
+    for (int i = 0; i < n_segs; i++)
+    {
+        if (!work_us(decode_us / n_segs, params.abort_callback,
+                     params.abort_callback_user_data))
+            return -7;
+
+        int64_t t0 = start_ms + (int64_t)i * seg_ms;
+        int64_t t1 = t0 + seg_ms < end_ms ? t0 + seg_ms : end_ms;
+        if (t1 > t0 && add_segment(ctx, t0 / 10, t1 / 10) == 0
+            && params.new_segment_callback)
+        {
+            params.new_segment_callback(ctx, NULL, 1,
+                                        params.new_segment_callback_user_data);
+        }
+
+        if (params.progress_callback)
+            params.progress_callback(ctx, NULL, (i + 1) * 100 / n_segs,
+                                     params.progress_callback_user_data);
+    }
+    return 0;
+}
+
+int
+whisper_full_n_segments(struct whisper_context *ctx)
+{
+    return ctx->n_segs;
+}
+
+int64_t
+whisper_full_get_segment_t0(struct whisper_context *ctx, int i)
+{
+    return ctx->segs[i].t0;
+}
+
+int64_t
+whisper_full_get_segment_t1(struct whisper_context *ctx, int i)
+{
+    return ctx->segs[i].t1;
+}
+
+const char *
+whisper_full_get_segment_text(struct whisper_context *ctx, int i)
+{
+    return ctx->segs[i].text;
+}
+
+int
+whisper_full_lang_id(struct whisper_context *ctx)
+{
+    return ctx->lang_id;
+}
+
+int
+whisper_full_get_prompt_past(struct whisper_context *ctx, whisper_token *tokens_out,
+                             int max_tokens)
+{
+    int n = ctx->params.prompt_tokens < max_tokens ? ctx->params.prompt_tokens : max_tokens;
+    for (int i = 0; i < n; i++)
+        tokens_out[i] = 50364 + i;
+    return n;
+}
+
+int
+whisper_n_text_ctx(struct whisper_context *ctx)
+{
+    (void)ctx;
+    return MOCK_TEXT_CTX;
+}
+
+int
+whisper_lang_id(const char *lang)
+{
+    return strcmp(lang, "en") == 0 ? 0 : -1;
+}
+
+const char *
+whisper_lang_str(int id)
+{
+    return id == 0 ? "en" : NULL;
+}
+
+void
+whisper_log_set(ggml_log_callback log_callback, void *user_data)
+{
+    (void)log_callback;
+    (void)user_data;
+}
+
+#ifdef WHISPER_MEM_USAGE
+void
+whisper_ctx_get_mem_usage(struct whisper_context *ctx, struct whisper_mem_usage *usage)
+{
+    (void)ctx;
+    usage->weights = 0;
+    usage->kv = 0;
+    usage->compute = 0;
+}
+#endif
+
+void
+whisper_set_vad_context(struct whisper_context *ctx, struct whisper_vad_context *vctx)
+{
+    (void)ctx;
+    (void)vctx;
+}
+
+struct whisper_vad_params
+whisper_vad_default_params(void)
+{
+    struct whisper_vad_params params;
+    memset(&params, 0, sizeof params);
+    params.threshold = 0.5f;
+    params.min_speech_duration_ms = 250;
+    params.min_silence_duration_ms = 100;
+    params.max_speech_duration_s = 30.0f;
+    params.speech_pad_ms = 30;
+    params.samples_overlap = 0.1f;
+    return params;
+}
+
+struct whisper_vad_context_params
+whisper_vad_default_context_params(void)
+{
+    struct whisper_vad_context_params params;
+    memset(&params, 0, sizeof params);
+    params.n_threads = 1;
+    return params;
+}
+
+struct whisper_vad_context *
+whisper_vad_init_from_file_with_params(const char *path,
+                                       struct whisper_vad_context_params params)
+{
+    (void)path;
+    (void)params;
+    struct whisper_vad_context *vctx = calloc(1, sizeof *vctx);
+    if (vctx)
+        vctx->params = g_params;
+    return vctx;
+}
+
+void
+whisper_vad_free(struct whisper_vad_context *vctx)
+{
+    free(vctx);
+}
+
+#ifdef WHISPER_MEM_USAGE
+size_t
+whisper_vad_get_mem_usage(struct whisper_vad_context *vctx)
+{
+    (void)vctx;
+    return 0;
+}
+#endif
+
+bool
+whisper_vad_detect_speech(struct whisper_vad_context *vctx, const float *samples,
+                          int n_samples)
+{
+    (void)samples;
+    vctx->n_samples = n_samples;
+    sleep_us((int64_t)(vctx->params.vad_ms_per_s * 1000.0 * n_samples / WHISPER_SAMPLE_RATE));
+    return true;
+}
+
+/* Speech and silence alternate from the start of the analysed audio */
+struct whisper_vad_segments *
+whisper_vad_segments_from_probs(struct whisper_vad_context *vctx,
+                                struct whisper_vad_params params)
+{
+    (void)params;
+    struct whisper_vad_segments *segs = calloc(1, sizeof *segs);
+    if (!segs)
+        return NULL;
+
+    int64_t len_cs = (int64_t)vctx->n_samples * 100 / WHISPER_SAMPLE_RATE;
+    int64_t speech_cs = vctx->params.speech_ms / 10;
+    int64_t period_cs = speech_cs + vctx->params.silence_ms / 10;
+    if (speech_cs <= 0 || period_cs <= 0)
+        return segs;
+
+    int cap = (int)(len_cs / period_cs) + 1;
+    segs->t = calloc(cap, sizeof *segs->t);
+    if (!segs->t)
+    {
+        free(segs);
+        return NULL;
+    }
+
+    for (int64_t t = 0; t < len_cs && segs->n < cap; t += period_cs)
+    {
+        segs->t[segs->n][0] = t;
+        segs->t[segs->n][1] = t + speech_cs < len_cs ? t + speech_cs : len_cs;
+        segs->n++;
+    }
+    return segs;
+}
+
+int
+whisper_vad_segments_n_segments(struct whisper_vad_segments *segments)
+{
+    return segments->n;
+}
+
+int64_t
+whisper_vad_segments_get_segment_t0(struct whisper_vad_segments *segments, int i_segment)
+{
+    return segments->t[i_segment][0];
+}
+
+int64_t
+whisper_vad_segments_get_segment_t1(struct whisper_vad_segments *segments, int i_segment)
+{
+    return segments->t[i_segment][1];
+}
+
+void
+whisper_vad_free_segments(struct whisper_vad_segments *segments)
+{
+    if (!segments)
+        return;
+    free(segments->t);
+    free(segments);
+}
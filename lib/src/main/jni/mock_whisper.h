@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Link-time replacement for libwhisper, enough for stream.c.
+ * whisper_full() sleeps instead of transcribing, so the scheduler can be
+ * benchmarked and stressed without a model. */
+
+#include <whisper.h>
+
+struct mock_whisper_params
+{
+    /* whisper_full() time: fixed_ms + rtf * audio ms, times a log-normal
+     * factor with mean 1 and the given sigma (0 for a fixed latency) */
+    int   fixed_ms;
+    float rtf;
+    float sigma;
+    /* Share of whisper_full() spent before the context callback (encoder) */
+    float encode_share;
+
+    /* VAD time per audio second */
+    float vad_ms_per_s;
+    /* Synthetic speech: speech_ms of speech then silence_ms of silence */
+    int   speech_ms;
+    int   silence_ms;
+
+    int   segment_ms;       /* length of the synthetic whisper segments */
+    int   prompt_tokens;    /* tokens returned by whisper_full_get_prompt_past */
+    unsigned seed;
+};
+
+struct mock_whisper_params
+mock_whisper_default_params(void);
+
+/* Applies to contexts created afterwards */
+void
+mock_whisper_set_params(const struct mock_whisper_params *params);
+
+/* Total time slept in whisper_full() and VAD by all contexts, in us */
+int64_t
+mock_whisper_busy_us(void);
@@ -0,0 +1,318 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Scheduler benchmark and stress test on the mock whisper backend.
+ * Runs several streams at once to measure chunk handoff overhead, lock
+ * waits and pipeline bubbles without a model. */
+
+#include "mock_whisper.h"
+#include "stream.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SLOTS 16
+
+struct mem_reader
+{
+    const float *samples;
+    int n_samples;
+    int pos;
+};
+
+struct bench_stream
+{
+    pthread_t thread;
+    struct whisper_context *ctx[2];
+    struct whisper_vad_context *vad[2];
+    struct mem_reader reader;
+    struct whisper_stream_stats stats;
+    int64_t abort_at_us;        /* 0 to never abort */
+    int ret;
+};
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int
+read_cb(float *out, int n_max, void *user_data)
+{
+    struct mem_reader *r = user_data;
+    int n = r->n_samples - r->pos < n_max ? r->n_samples - r->pos : n_max;
+    if (n > 0)
+    {
+        memcpy(out, r->samples + r->pos, n * sizeof *out);
+        r->pos += n;
+    }
+    return n;
+}
+
+static bool
+abort_cb(void *user_data)
+{
+    struct bench_stream *s = user_data;
+    return s->abort_at_us && now_us() >= s->abort_at_us;
+}
+
+static void *
+stream_thread_func(void *arg)
+{
+    struct bench_stream *s = arg;
+
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    struct whisper_stream_params sparams = whisper_stream_default_params();
+    sparams.read_callback = read_cb;
+    sparams.read_callback_user_data = &s->reader;
+    sparams.abort_callback = abort_cb;
+    sparams.abort_callback_user_data = s;
+    sparams.stats = &s->stats;
+    for (int i = 0; i < 2; i++)
+    {
+        sparams.slots[i].ctx = s->ctx[i];
+        sparams.slots[i].vad_ctx = s->vad[i];
+        sparams.slots[i].num_threads = 1;
+    }
+
+    s->ret = whisper_stream_full(wparams, sparams);
+    return NULL;
+}
+
+/* Runs n_streams streams of slots_per_stream slots each over the same audio,
+ * returns the wall time in us, negative on error */
+static int64_t
+run_streams(struct bench_stream *streams, int n_streams, int slots_per_stream,
+            const float *samples, int n_samples, int64_t abort_after_us)
+{
+    struct whisper_context_params cparams = whisper_context_default_params();
+    struct whisper_vad_context_params vparams = whisper_vad_default_context_params();
+    int64_t wall_us = -1;
+
+    memset(streams, 0, n_streams * sizeof *streams);
+    for (int i = 0; i < n_streams; i++)
+    {
+        struct bench_stream *s = &streams[i];
+        for (int j = 0; j < slots_per_stream; j++)
+        {
+            s->ctx[j] = whisper_init_from_file_with_params("mock", cparams);
+            s->vad[j] = whisper_vad_init_from_file_with_params("mock", vparams);
+            if (!s->ctx[j] || !s->vad[j])
+                goto cleanup;
+        }
+        s->reader = (struct mem_reader){ samples, n_samples, 0 };
+    }
+
+    int64_t start_us = now_us();
+    int started = 0;
+    for (; started < n_streams; started++)
+    {
+        struct bench_stream *s = &streams[started];
+        if (abort_after_us > 0)
+            s->abort_at_us = start_us + rand() % abort_after_us;
+        if (pthread_create(&s->thread, NULL, stream_thread_func, s) != 0)
+            break;
+    }
+    for (int i = 0; i < started; i++)
+        pthread_join(streams[i].thread, NULL);
+    if (started == n_streams)
+        wall_us = now_us() - start_us;
+
+cleanup:
+    for (int i = 0; i < n_streams; i++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            if (streams[i].vad[j])
+                whisper_vad_free(streams[i].vad[j]);
+            if (streams[i].ctx[j])
+                whisper_free(streams[i].ctx[j]);
+        }
+    }
+    return wall_us;
+}
+
+static int
+bench_config(int n_slots, const float *samples, int n_samples, int reps)
+{
+    int slots_per_stream = n_slots > 1 ? 2 : 1;
+    int n_streams = n_slots / slots_per_stream;
+    struct bench_stream streams[MAX_SLOTS];
+    double wall_ms = 0, ideal_ms = 0;
+    int64_t time_us[WHISPER_STREAM_TIME_COUNT] = {0};
+    int64_t slot_us = 0;
+    int n_chunks = 0;
+
+    for (int r = 0; r < reps; r++)
+    {
+        int64_t busy_before = mock_whisper_busy_us();
+        int64_t wall_us = run_streams(streams, n_streams, slots_per_stream,
+                                      samples, n_samples, 0);
+        if (wall_us < 0)
+            return -1;
+
+        wall_ms += wall_us / 1000.0;
+        ideal_ms += (mock_whisper_busy_us() - busy_before) / 1000.0 / n_slots;
+
+        for (int i = 0; i < n_streams; i++)
+        {
+            if (streams[i].ret != 0)
+            {
+                fprintf(stderr, "stream %d failed: %d\n", i, streams[i].ret);
+                return -1;
+            }
+            for (int j = 0; j < slots_per_stream; j++)
+            {
+                const struct whisper_stream_slot_stats *ss = &streams[i].stats.slots[j];
+                for (int t = 0; t < WHISPER_STREAM_TIME_COUNT; t++)
+                    time_us[t] += ss->time_us[t];
+                slot_us += ss->wall_us;
+                n_chunks += ss->n_chunks;
+            }
+        }
+    }
+
+    printf("SCHED: %2d slots | %2d streams | %.0fs audio | wall=%.0fms | ideal=%.0fms | overhead=%.1f%% | chunks=%d",
+           n_slots, n_streams, (double)n_samples / WHISPER_SAMPLE_RATE,
+           wall_ms / reps, ideal_ms / reps,
+           ideal_ms > 0 ? (wall_ms / ideal_ms - 1.0) * 100.0 : 0.0,
+           n_chunks / reps);
+    for (int t = 0; t < WHISPER_STREAM_TIME_COUNT; t++)
+        printf(" | %s=%.1f%%", whisper_stream_time_name(t),
+               slot_us > 0 ? time_us[t] * 100.0 / slot_us : 0.0);
+    printf("\n");
+    fflush(stdout);
+    return 0;
+}
+
+/* Random layouts with random aborts, meant to run under TSAN */
+static int
+stress(int iterations, const float *samples, int n_samples)
+{
+    struct bench_stream streams[MAX_SLOTS];
+
+    for (int it = 0; it < iterations; it++)
+    {
+        int slots_per_stream = 1 + rand() % 2;
+        int n_streams = 1 + rand() % (MAX_SLOTS / slots_per_stream);
+        int64_t abort_after_us = rand() % 2 ? 500000 : 0;
+
+        if (run_streams(streams, n_streams, slots_per_stream,
+                        samples, n_samples, abort_after_us) < 0)
+            return -1;
+
+        for (int i = 0; i < n_streams; i++)
+        {
+            if (streams[i].ret != 0 && !streams[i].abort_at_us)
+            {
+                fprintf(stderr, "stress %d: stream %d failed: %d\n", it, i, streams[i].ret);
+                return -1;
+            }
+        }
+        fprintf(stderr, "stress %d: %d x %d slots%s\n", it, n_streams,
+                slots_per_stream, abort_after_us ? ", aborting" : "");
+    }
+    return 0;
+}
+
+static void
+usage(const char *prog)
+{
+    struct mock_whisper_params mp = mock_whisper_default_params();
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -a, --audio S         Synthetic audio length in seconds (default: 600)\n");
+    fprintf(stderr, "  -n, --slots N         Total slots, 1 or even up to %d (default: sweep 1,2,4,8,16)\n", MAX_SLOTS);
+    fprintf(stderr, "  -r, --reps N          Runs per configuration (default: 3)\n");
+    fprintf(stderr, "      --rtf F           Mock whisper_full() time per audio time (default: %.3f)\n", mp.rtf);
+    fprintf(stderr, "      --fixed-ms N      Mock whisper_full() fixed time (default: %d)\n", mp.fixed_ms);
+    fprintf(stderr, "      --sigma F         Log-normal latency spread, 0 for fixed (default: %.2f)\n", mp.sigma);
+    fprintf(stderr, "      --speech-ms N     Mock VAD speech length (default: %d)\n", mp.speech_ms);
+    fprintf(stderr, "      --silence-ms N    Mock VAD silence length (default: %d)\n", mp.silence_ms);
+    fprintf(stderr, "      --stress N        Run N random layouts with random aborts instead\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    struct mock_whisper_params mp = mock_whisper_default_params();
+    int audio_s = 600;
+    int n_slots = 0;
+    int reps = 3;
+    int stress_iterations = 0;
+
+    enum { OPT_RTF = 256, OPT_FIXED, OPT_SIGMA, OPT_SPEECH, OPT_SILENCE, OPT_STRESS };
+    static struct option long_opts[] = {
+        {"audio",      required_argument, 0, 'a'},
+        {"slots",      required_argument, 0, 'n'},
+        {"reps",       required_argument, 0, 'r'},
+        {"rtf",        required_argument, 0, OPT_RTF},
+        {"fixed-ms",   required_argument, 0, OPT_FIXED},
+        {"sigma",      required_argument, 0, OPT_SIGMA},
+        {"speech-ms",  required_argument, 0, OPT_SPEECH},
+        {"silence-ms", required_argument, 0, OPT_SILENCE},
+        {"stress",     required_argument, 0, OPT_STRESS},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "a:n:r:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'a': audio_s = atoi(optarg); break;
+        case 'n': n_slots = atoi(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case OPT_RTF: mp.rtf = atof(optarg); break;
+        case OPT_FIXED: mp.fixed_ms = atoi(optarg); break;
+        case OPT_SIGMA: mp.sigma = atof(optarg); break;
+        case OPT_SPEECH: mp.speech_ms = atoi(optarg); break;
+        case OPT_SILENCE: mp.silence_ms = atoi(optarg); break;
+        case OPT_STRESS: stress_iterations = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (audio_s < 1 || reps < 1 || n_slots < 0 || n_slots > MAX_SLOTS
+        || (n_slots > 1 && n_slots % 2))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    mock_whisper_set_params(&mp);
+    srand(mp.seed);
+
+    int n_samples = audio_s * WHISPER_SAMPLE_RATE;
+    float *samples = calloc(n_samples, sizeof *samples);
+    if (!samples)
+        return 1;
+
+    int ret = 0;
+    if (stress_iterations > 0)
+    {
+        ret = stress(stress_iterations, samples, n_samples) < 0;
+    }
+    else if (n_slots > 0)
+    {
+        ret = bench_config(n_slots, samples, n_samples, reps) < 0;
+    }
+    else
+    {
+        for (int n = 1; n <= MAX_SLOTS && !ret; n *= 2)
+            ret = bench_config(n, samples, n_samples, reps) < 0;
+    }
+
+    free(samples);
+    return ret;
+}
@@ -0,0 +1,358 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Size contributions of objects and symbols to a shared library, read from
+ * the link map (-Wl,-Map, lld or GNU ld). With -ffunction-sections and
+ * -fdata-sections every function and variable has an input section of its
+ * own, which gives the per-symbol sizes. Sections that are not loaded
+ * (debug info, .bss) are not counted. */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct input_section
+{
+    char *object;               /* basename, archive(member) kept */
+    char *symbol;               /* from the section name */
+    uint64_t size;
+};
+
+struct report
+{
+    struct input_section *sections;
+    int n_sections;
+    int cap_sections;
+    uint64_t total;
+};
+
+/* Output sections that take space in the file */
+static bool
+counted_output(const char *name)
+{
+    static const char *const skipped[] = {
+        ".debug", ".comment", ".symtab", ".strtab", ".shstrtab", ".bss", ".tbss",
+        ".stab", ".note.GNU-stack", "/DISCARD/",
+    };
+    for (size_t i = 0; i < sizeof skipped / sizeof skipped[0]; i++)
+        if (strncmp(name, skipped[i], strlen(skipped[i])) == 0)
+            return false;
+    return true;
+}
+
+/* ".text.unlikely.foo" -> "foo", a section without a name suffix stays as is */
+static const char *
+section_symbol(const char *section)
+{
+    static const char *const prefixes[] = {
+        ".text.unlikely.", ".text.hot.", ".text.startup.", ".text.exit.", ".text.",
+        ".rodata.str", ".rodata.cst", ".rodata.", ".data.rel.ro.local.", ".data.rel.ro.",
+        ".data.rel.local.", ".data.rel.", ".data.", ".tdata.",
+    };
+    for (size_t i = 0; i < sizeof prefixes / sizeof prefixes[0]; i++)
+    {
+        size_t len = strlen(prefixes[i]);
+        if (strncmp(section, prefixes[i], len) == 0 && section[len])
+        {
+            /* Merged string and constant pools have no symbol */
+            if (strncmp(prefixes[i], ".rodata.str", 11) == 0
+                || strncmp(prefixes[i], ".rodata.cst", 11) == 0)
+                return section;
+            return section + len;
+        }
+    }
+    return section;
+}
+
+static const char *
+object_basename(const char *path)
+{
+    /* Keep "libggml.a(ggml.c.o)" whole, its directory may contain '(' */
+    const char *paren = strchr(path, '(');
+    const char *end = paren ? paren : path + strlen(path);
+    const char *base = path;
+    for (const char *p = path; p < end; p++)
+        if (*p == '/')
+            base = p + 1;
+    return base;
+}
+
+static int
+add_section(struct report *r, const char *object, const char *section, uint64_t size)
+{
+    if (size == 0)
+        return 0;
+
+    if (r->n_sections == r->cap_sections)
+    {
+        int cap = r->cap_sections ? r->cap_sections * 2 : 1024;
+        struct input_section *s = realloc(r->sections, cap * sizeof *s);
+        if (!s)
+            return -1;
+        r->sections = s;
+        r->cap_sections = cap;
+    }
+
+    struct input_section *s = &r->sections[r->n_sections];
+    s->object = strdup(object_basename(object));
+    s->symbol = strdup(section_symbol(section));
+    if (!s->object || !s->symbol)
+    {
+        free(s->object);
+        free(s->symbol);
+        return -1;
+    }
+    s->size = size;
+    r->n_sections++;
+    r->total += size;
+    return 0;
+}
+
+static void
+chomp(char *line)
+{
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        line[--len] = '\0';
+}
+
+/* lld: "VMA LMA Size Align Out In Symbol", the column of the name after the
+ * alignment tells output sections (0), input sections (8) and symbols (16) */
+static int
+parse_lld(FILE *f, struct report *r)
+{
+    char line[4096];
+    bool counted = false;
+
+    while (fgets(line, sizeof line, f))
+    {
+        chomp(line);
+        unsigned long long vma, lma, size, align;
+        int n = 0;
+        if (sscanf(line, "%llx %llx %llx %llu%n", &vma, &lma, &size, &align, &n) != 4)
+            continue;
+
+        const char *rest = line + n + 1;
+        int indent = 0;
+        while (rest[indent] == ' ')
+            indent++;
+        const char *name = rest + indent;
+
+        if (indent == 0)
+        {
+            counted = counted_output(name);
+            continue;
+        }
+        if (indent != 8 || !counted)
+            continue;
+
+        /* "path/to/foo.o:(.text.bar)" */
+        char *sep = strstr(name, ":(");
+        if (!sep)
+            continue;
+        *sep = '\0';
+        char *section = sep + 2;
+        size_t len = strlen(section);
+        if (len > 0 && section[len - 1] == ')')
+            section[len - 1] = '\0';
+        if (add_section(r, name, section, size) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* GNU ld: after "Linker script and memory map", output sections start at
+ * column 0, input sections at column 1 with the address, size and object on
+ * the same line or on the next one when the section name is long */
+static int
+parse_gnu(FILE *f, struct report *r)
+{
+    char line[4096];
+    char section[1024] = "";
+    bool counted = false;
+    bool in_map = false;
+
+    while (fgets(line, sizeof line, f))
+    {
+        chomp(line);
+        if (!in_map)
+        {
+            in_map = strncmp(line, "Linker script and memory map", 28) == 0;
+            continue;
+        }
+
+        if (line[0] == '.' || line[0] == '/')
+        {
+            char name[1024];
+            if (sscanf(line, "%1023s", name) == 1)
+                counted = counted_output(name);
+            section[0] = '\0';
+            continue;
+        }
+
+        unsigned long long addr, size;
+        char object[2048];
+        if (line[0] == ' ' && line[1] == '.')
+        {
+            int n = 0;
+            if (sscanf(line, " %1023s%n", section, &n) != 1)
+                continue;
+            /* Short names are followed by the rest on the same line */
+            if (sscanf(line + n, " %llx %llx %2047[^\n]", &addr, &size, object) != 3)
+                continue;
+        }
+        else if (section[0] && sscanf(line, " %llx %llx %2047[^\n]", &addr, &size, object) == 3)
+        {
+            /* Continuation of a long section name */
+        }
+        else
+        {
+            continue;
+        }
+
+        if (counted && add_section(r, object, section, size) < 0)
+            return -1;
+        section[0] = '\0';
+    }
+    return 0;
+}
+
+static int
+compare_size(const void *a, const void *b)
+{
+    const struct input_section *x = a, *y = b;
+    return x->size < y->size ? 1 : x->size > y->size ? -1 : 0;
+}
+
+static int
+compare_object(const void *a, const void *b)
+{
+    const struct input_section *x = a, *y = b;
+    return strcmp(x->object, y->object);
+}
+
+/* Folds sections into one entry per object, reusing the array */
+static int
+group_objects(struct report *r)
+{
+    qsort(r->sections, r->n_sections, sizeof *r->sections, compare_object);
+
+    int n = 0;
+    for (int i = 0; i < r->n_sections; i++)
+    {
+        if (n > 0 && strcmp(r->sections[n - 1].object, r->sections[i].object) == 0)
+        {
+            r->sections[n - 1].size += r->sections[i].size;
+            free(r->sections[i].object);
+            free(r->sections[i].symbol);
+            continue;
+        }
+        r->sections[n++] = r->sections[i];
+    }
+    return n;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options] file.map\n", prog);
+    fprintf(stderr, "  -n, --top N           Entries per list (default: 30)\n");
+    fprintf(stderr, "  -o, --objects         Objects only\n");
+    fprintf(stderr, "  -s, --symbols         Symbols only\n");
+    fprintf(stderr, "Link with -Wl,-Map=file.map, CMake does with -DWHISPER_SIZE_REPORT=ON\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int top = 30;
+    bool objects = true;
+    bool symbols = true;
+
+    static struct option long_opts[] = {
+        {"top",     required_argument, 0, 'n'},
+        {"objects", no_argument,       0, 'o'},
+        {"symbols", no_argument,       0, 's'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:os", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': top = atoi(optarg); break;
+        case 'o': symbols = false; break;
+        case 's': objects = false; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1 || top < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *path = argv[optind];
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return 1;
+    }
+
+    char first[256] = "";
+    if (!fgets(first, sizeof first, f))
+        first[0] = '\0';
+    rewind(f);
+
+    struct report r = { NULL, 0, 0, 0 };
+    int ret = strstr(first, "VMA") && strstr(first, "Symbol") ? parse_lld(f, &r)
+                                                                : parse_gnu(f, &r);
+    fclose(f);
+    if (ret < 0 || r.n_sections == 0)
+    {
+        fprintf(stderr, ret < 0 ? "Out of memory\n" : "No input sections in %s\n", path);
+        ret = 1;
+        goto cleanup;
+    }
+
+    printf("SIZE: %s | %.1fKiB | %d sections\n", path, r.total / 1024.0, r.n_sections);
+
+    if (symbols)
+    {
+        qsort(r.sections, r.n_sections, sizeof *r.sections, compare_size);
+        for (int i = 0; i < r.n_sections && i < top; i++)
+        {
+            const struct input_section *s = &r.sections[i];
+            printf("SYMBOL: %s | %s | %.1fKiB | %.1f%%\n", s->symbol, s->object,
+                   s->size / 1024.0, 100.0 * s->size / r.total);
+        }
+    }
+
+    if (objects)
+    {
+        r.n_sections = group_objects(&r);
+        qsort(r.sections, r.n_sections, sizeof *r.sections, compare_size);
+        for (int i = 0; i < r.n_sections && i < top; i++)
+        {
+            const struct input_section *s = &r.sections[i];
+            printf("OBJECT: %s | %.1fKiB | %.1f%%\n", s->object, s->size / 1024.0,
+                   100.0 * s->size / r.total);
+        }
+    }
+    ret = 0;
+
+cleanup:
+    for (int i = 0; i < r.n_sections; i++)
+    {
+        free(r.sections[i].object);
+        free(r.sections[i].symbol);
+    }
+    free(r.sections);
+    return ret;
+}
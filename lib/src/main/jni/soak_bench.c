@@ -0,0 +1,539 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Hours of looped audio through one whisper_stream_full() call, sampling
+ * throughput and memory per window of audio to catch drift and leaks that
+ * a single file does not show. */
+
+#include "audio.h"
+#include "stream.h"
+
+#include <getopt.h>
+#include <malloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Relative to lib/src/main/jni, where the Makefile lives */
+#define DEFAULT_MODEL      "../../../../models_pack/src/main/assets/models/ggml-small-q8_0.bin"
+#define DEFAULT_VAD_MODEL  "../../../../models_pack/src/main/assets/models/ggml-silero-v6.2.0.bin"
+#define DEFAULT_CORPUS     "../../../../app/src/androidTest/assets/test_long_273s.opus"
+
+#define MIB (1024.0 * 1024.0)
+
+static atomic_bool g_abort;
+
+/* One window of audio */
+struct soak_sample
+{
+    double audio_h;         /* audio streamed at the end of the window */
+    double rtf;             /* wall time / audio time over the window */
+    size_t rss;
+    size_t heap_used;       /* allocator bytes in use */
+    size_t heap_free;       /* allocator bytes free but kept, fragmentation */
+    size_t stream_mem;      /* whisper_stream_mem_stats cur, all slots */
+    int n_chunks;
+};
+
+struct soak_ctx
+{
+    /* Looped corpus */
+    const float *samples;
+    int n_samples;
+    int pos;
+    int64_t read_samples;
+    int64_t total_samples;
+
+    pthread_mutex_t lock;
+    int64_t window_samples;
+    int64_t window_start_us;
+    int64_t window_audio;       /* samples transcribed in the current window */
+    int64_t done_samples;
+    int window_chunks;
+    size_t slot_mem[2];
+
+    struct soak_sample *series;
+    int n_series;
+    int max_series;
+    FILE *csv;
+};
+
+static void
+sigint_handler(int sig)
+{
+    (void)sig;
+    atomic_store(&g_abort, true);
+}
+
+static bool
+abort_cb(void *user_data)
+{
+    (void)user_data;
+    return atomic_load(&g_abort);
+}
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+log_disable(enum ggml_log_level level, const char *text, void *user_data)
+{
+    (void)level;
+    (void)text;
+    (void)user_data;
+}
+
+static size_t
+read_rss(void)
+{
+    long pages = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f)
+    {
+        if (fscanf(f, "%*s %ld", &pages) != 1)
+            pages = 0;
+        fclose(f);
+    }
+    return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static void
+read_heap(size_t *used, size_t *free_bytes)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+#else
+    struct mallinfo mi = mallinfo();
+#endif
+    /* Large buffers are mmap()ed, they count as used but never as free */
+    *used = (size_t)mi.uordblks + (size_t)mi.hblkhd;
+    *free_bytes = (size_t)mi.fordblks;
+}
+
+/* The corpus over and over until total_samples */
+static int
+loop_read_cb(float *out, int n_max, void *user_data)
+{
+    struct soak_ctx *sc = user_data;
+    int64_t left = sc->total_samples - sc->read_samples;
+    int n = 0;
+
+    while (n < n_max && left > 0)
+    {
+        int count = sc->n_samples - sc->pos;
+        if (count > n_max - n)
+            count = n_max - n;
+        if (count > left)
+            count = (int)left;
+        memcpy(out + n, sc->samples + sc->pos, count * sizeof *out);
+        n += count;
+        left -= count;
+        sc->pos = (sc->pos + count) % sc->n_samples;
+    }
+    sc->read_samples += n;
+    return n;
+}
+
+static void
+close_window(struct soak_ctx *sc, int64_t now)
+{
+    struct soak_sample s;
+    memset(&s, 0, sizeof s);
+    s.audio_h = (double)sc->done_samples / WHISPER_SAMPLE_RATE / 3600.0;
+    s.rtf = (double)(now - sc->window_start_us) / 1e6
+          / ((double)sc->window_audio / WHISPER_SAMPLE_RATE);
+    s.rss = read_rss();
+    read_heap(&s.heap_used, &s.heap_free);
+    s.stream_mem = sc->slot_mem[0] + sc->slot_mem[1];
+    s.n_chunks = sc->window_chunks;
+
+    printf("SOAK: %.2fh | RTF=%.3fx | rss=%.1fMiB | heap=%.1fMiB | heap_free=%.1fMiB"
+           " | stream=%.1fMiB | chunks=%d\n",
+           s.audio_h, s.rtf, s.rss / MIB, s.heap_used / MIB, s.heap_free / MIB,
+           s.stream_mem / MIB, s.n_chunks);
+    fflush(stdout);
+
+    if (sc->csv)
+    {
+        fprintf(sc->csv, "%.4f,%.4f,%zu,%zu,%zu,%zu,%d\n", s.audio_h, s.rtf, s.rss,
+                s.heap_used, s.heap_free, s.stream_mem, s.n_chunks);
+        fflush(sc->csv);
+    }
+
+    if (sc->n_series < sc->max_series)
+        sc->series[sc->n_series++] = s;
+
+    sc->window_start_us = now;
+    sc->window_audio = 0;
+    sc->window_chunks = 0;
+}
+
+/* Concurrent from both slots in dual mode */
+static void
+chunk_cb(const struct whisper_stream_chunk_stats *chunk, void *user_data)
+{
+    struct soak_ctx *sc = user_data;
+
+    pthread_mutex_lock(&sc->lock);
+    size_t mem = 0;
+    for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+        mem += chunk->mem.cur[c];
+    sc->slot_mem[chunk->slot & 1] = mem;
+
+    sc->window_audio += chunk->samples;
+    sc->done_samples += chunk->samples;
+    sc->window_chunks++;
+    if (sc->window_audio >= sc->window_samples)
+        close_window(sc, now_us());
+    pthread_mutex_unlock(&sc->lock);
+}
+
+struct trend
+{
+    double slope;       /* least squares, per hour */
+    double low;         /* about the 95% lower bound of the slope */
+};
+
+static struct trend
+fit_trend(const double *x, const double *y, int n)
+{
+    struct trend t = { 0, 0 };
+    double mx = 0, my = 0, sxx = 0, sxy = 0, sse = 0;
+    for (int i = 0; i < n; i++)
+    {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= n;
+    my /= n;
+    for (int i = 0; i < n; i++)
+    {
+        sxx += (x[i] - mx) * (x[i] - mx);
+        sxy += (x[i] - mx) * (y[i] - my);
+    }
+    if (sxx <= 0)
+        return t;
+
+    t.slope = sxy / sxx;
+    for (int i = 0; i < n; i++)
+    {
+        double r = y[i] - my - t.slope * (x[i] - mx);
+        sse += r * r;
+    }
+    t.low = n > 2 ? t.slope - 2 * sqrt(sse / (n - 2) / sxx) : t.slope;
+    return t;
+}
+
+/* Trends after the first window, which includes the warm-up. A limit is
+ * only exceeded when the slope is above it beyond the window to window noise.
+ * Returns the number of limits exceeded. */
+static int
+print_summary(const struct soak_ctx *sc, double max_drift, double max_growth)
+{
+    int n = sc->n_series - 1;
+    if (n < 2)
+    {
+        fprintf(stderr, "Not enough windows for trends (%d)\n", sc->n_series);
+        return 0;
+    }
+
+    const struct soak_sample *s = sc->series + 1;
+    double *x = malloc(5 * n * sizeof *x);
+    if (!x)
+        return 0;
+    double *rtf = x + n, *rss = x + 2 * n, *heap = x + 3 * n, *frag = x + 4 * n;
+    double mean_rtf = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        x[i] = s[i].audio_h;
+        rtf[i] = s[i].rtf;
+        rss[i] = s[i].rss / MIB;
+        heap[i] = s[i].heap_used / MIB;
+        frag[i] = s[i].heap_free / MIB;
+        mean_rtf += s[i].rtf / n;
+    }
+
+    struct trend drift = fit_trend(x, rtf, n);
+    struct trend rss_growth = fit_trend(x, rss, n);
+    struct trend heap_growth = fit_trend(x, heap, n);
+    struct trend frag_growth = fit_trend(x, frag, n);
+    free(x);
+    if (mean_rtf > 0)
+    {
+        drift.slope /= mean_rtf;
+        drift.low /= mean_rtf;
+    }
+
+    printf("SOAK SUMMARY: %.2fh | %d windows | RTF=%.3fx | drift=%+.1f%%/h | rss=%+.1fMiB/h"
+           " | heap=%+.1fMiB/h | heap_free=%+.1fMiB/h\n",
+           s[n - 1].audio_h, sc->n_series, mean_rtf, drift.slope * 100, rss_growth.slope,
+           heap_growth.slope, frag_growth.slope);
+
+    int exceeded = 0;
+    if (drift.low > max_drift)
+    {
+        printf("DRIFT: throughput degrades %.1f%%/h, limit %.1f%%/h\n",
+               drift.slope * 100, max_drift * 100);
+        exceeded++;
+    }
+    if (rss_growth.low > max_growth || heap_growth.low > max_growth)
+    {
+        printf("GROWTH: rss %+.1fMiB/h, heap %+.1fMiB/h, limit %.1fMiB/h\n",
+               rss_growth.slope, heap_growth.slope, max_growth);
+        exceeded++;
+    }
+    if (frag_growth.low > max_growth)
+    {
+        printf("FRAGMENTATION: free heap %+.1fMiB/h, limit %.1fMiB/h\n",
+               frag_growth.slope, max_growth);
+        exceeded++;
+    }
+    fflush(stdout);
+    return exceeded;
+}
+
+/* Files concatenated, malloc()ed */
+static float *
+read_corpus(const char **files, int n_files, int *n_samples)
+{
+    float *all = NULL;
+    *n_samples = 0;
+
+    for (int f = 0; f < n_files; f++)
+    {
+        int n;
+        float *samples = read_avcodec(files[f], &n);
+        if (!samples)
+        {
+            free(all);
+            return NULL;
+        }
+        float *tmp = realloc(all, ((size_t)*n_samples + n) * sizeof *all);
+        if (!tmp)
+        {
+            free(samples);
+            free(all);
+            return NULL;
+        }
+        all = tmp;
+        memcpy(all + *n_samples, samples, (size_t)n * sizeof *all);
+        *n_samples += n;
+        free(samples);
+    }
+    return all;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options] [audio files...]\n", prog);
+    fprintf(stderr, "  -m, --model PATH       Model (default: %s)\n", DEFAULT_MODEL);
+    fprintf(stderr, "  -v, --vad-model PATH   VAD model (default: %s)\n", DEFAULT_VAD_MODEL);
+    fprintf(stderr, "  -M, --mode MODE        cpu, dual, gpu or turbo (default: cpu)\n");
+    fprintf(stderr, "  -t, --threads N        CPU threads (default: all cores)\n");
+    fprintf(stderr, "  -H, --hours H          Audio to stream (default: 4)\n");
+    fprintf(stderr, "  -w, --window MIN       Audio minutes per sample (default: 10)\n");
+    fprintf(stderr, "      --csv FILE         Write the samples as CSV\n");
+    fprintf(stderr, "      --max-drift F      Relative RTF increase per hour (default: 0.02)\n");
+    fprintf(stderr, "      --max-growth MIB   Memory growth per hour (default: 4)\n");
+    fprintf(stderr, "The files are concatenated and looped, default %s\n", DEFAULT_CORPUS);
+    fprintf(stderr, "Exits with 2 when a limit is exceeded, Ctrl-C stops early\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *model = DEFAULT_MODEL;
+    const char *vad_model = DEFAULT_VAD_MODEL;
+    const char *mode = "cpu";
+    const char *csv_path = NULL;
+    int n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double hours = 4;
+    double window_min = 10;
+    double max_drift = 0.02;
+    double max_growth = 4;
+
+    enum { OPT_CSV = 256, OPT_MAX_DRIFT, OPT_MAX_GROWTH };
+    static struct option long_opts[] = {
+        {"model",      required_argument, 0, 'm'},
+        {"vad-model",  required_argument, 0, 'v'},
+        {"mode",       required_argument, 0, 'M'},
+        {"threads",    required_argument, 0, 't'},
+        {"hours",      required_argument, 0, 'H'},
+        {"window",     required_argument, 0, 'w'},
+        {"csv",        required_argument, 0, OPT_CSV},
+        {"max-drift",  required_argument, 0, OPT_MAX_DRIFT},
+        {"max-growth", required_argument, 0, OPT_MAX_GROWTH},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:v:M:t:H:w:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'm': model = optarg; break;
+        case 'v': vad_model = optarg; break;
+        case 'M': mode = optarg; break;
+        case 't': n_threads = atoi(optarg); break;
+        case 'H': hours = atof(optarg); break;
+        case 'w': window_min = atof(optarg); break;
+        case OPT_CSV: csv_path = optarg; break;
+        case OPT_MAX_DRIFT: max_drift = atof(optarg); break;
+        case OPT_MAX_GROWTH: max_growth = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Thread counts of stream_bench */
+    bool gpu = false, dual = false;
+    int threads[2] = { n_threads < 1 ? 1 : n_threads, 0 };
+    if (strcasecmp(mode, "dual") == 0)
+    {
+        dual = true;
+        threads[0] = n_threads > 1 ? n_threads / 2 : 1;
+        threads[1] = n_threads > 1 ? n_threads - threads[0] : 1;
+    }
+    else if (strcasecmp(mode, "gpu") == 0 || strcasecmp(mode, "turbo") == 0)
+    {
+        gpu = true;
+        dual = strcasecmp(mode, "turbo") == 0;
+        threads[0] = 1;
+        threads[1] = n_threads > 1 ? (n_threads - 1 > 8 ? 8 : n_threads - 1) : 1;
+    }
+    else if (strcasecmp(mode, "cpu") != 0)
+    {
+        fprintf(stderr, "Unknown mode: %s\n", mode);
+        return 1;
+    }
+    if (hours <= 0 || window_min <= 0)
+    {
+        fprintf(stderr, "hours and window must be > 0\n");
+        return 1;
+    }
+
+    whisper_log_set(log_disable, NULL);
+
+    const char *default_corpus[] = { DEFAULT_CORPUS };
+    const char **files = (const char **)argv + optind;
+    int n_files = argc - optind;
+    if (n_files == 0)
+    {
+        files = default_corpus;
+        n_files = 1;
+    }
+
+    int ret = 1;
+    struct whisper_context *ctx[2] = { NULL, NULL };
+    struct whisper_vad_context *vad[2] = { NULL, NULL };
+    struct soak_ctx sc;
+    memset(&sc, 0, sizeof sc);
+    pthread_mutex_init(&sc.lock, NULL);
+
+    sc.samples = read_corpus(files, n_files, &sc.n_samples);
+    if (!sc.samples || sc.n_samples == 0)
+        goto cleanup;
+
+    sc.total_samples = (int64_t)(hours * 3600 * WHISPER_SAMPLE_RATE);
+    sc.window_samples = (int64_t)(window_min * 60 * WHISPER_SAMPLE_RATE);
+    sc.max_series = (int)(sc.total_samples / sc.window_samples) + 2;
+    sc.series = calloc(sc.max_series, sizeof *sc.series);
+    if (!sc.series)
+        goto cleanup;
+
+    if (csv_path)
+    {
+        sc.csv = fopen(csv_path, "w");
+        if (!sc.csv)
+        {
+            fprintf(stderr, "Failed to create %s\n", csv_path);
+            goto cleanup;
+        }
+        fprintf(sc.csv, "audio_h,rtf,rss,heap_used,heap_free,stream_mem,chunks\n");
+    }
+
+    for (int i = 0; i < (dual ? 2 : 1); i++)
+    {
+        struct whisper_context_params cparams = whisper_context_default_params();
+        cparams.flash_attn = cparams.use_gpu = gpu && i == 0;
+        ctx[i] = whisper_init_from_file_with_params(model, cparams);
+        if (!ctx[i])
+        {
+            fprintf(stderr, "Failed to load model: %s\n", model);
+            goto cleanup;
+        }
+
+        struct whisper_vad_context_params vp = whisper_vad_default_context_params();
+        vp.n_threads = 1;
+        vp.use_gpu = false;
+        vad[i] = whisper_vad_init_from_file_with_params(vad_model, vp);
+        if (!vad[i])
+        {
+            fprintf(stderr, "Failed to load VAD model: %s\n", vad_model);
+            goto cleanup;
+        }
+    }
+
+    fprintf(stderr, "Streaming %.1fh of a %.1fs corpus, %s, samples every %.0f min\n",
+            hours, (float)sc.n_samples / WHISPER_SAMPLE_RATE, mode, window_min);
+
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.language = "en";
+    wparams.suppress_nst = true;
+
+    struct whisper_stream_params sparams = whisper_stream_default_params();
+    for (int i = 0; i < 2; i++)
+    {
+        sparams.slots[i].ctx = ctx[i];
+        sparams.slots[i].vad_ctx = vad[i];
+        sparams.slots[i].num_threads = threads[i];
+    }
+    sparams.read_callback = loop_read_cb;
+    sparams.read_callback_user_data = &sc;
+    sparams.chunk_callback = chunk_cb;
+    sparams.chunk_callback_user_data = &sc;
+    sparams.abort_callback = abort_cb;
+
+    signal(SIGINT, sigint_handler);
+    sc.window_start_us = now_us();
+    int result = whisper_stream_full(wparams, sparams);
+    if (result != 0 && !atomic_load(&g_abort))
+    {
+        fprintf(stderr, "whisper_stream_full failed: %d\n", result);
+        goto cleanup;
+    }
+
+    /* A partial last window is too short to compare, drop it */
+    ret = print_summary(&sc, max_drift, max_growth) > 0 ? 2 : 0;
+
+cleanup:
+    for (int i = 0; i < 2; i++)
+    {
+        if (vad[i])
+            whisper_vad_free(vad[i]);
+        if (ctx[i])
+            whisper_free(ctx[i]);
+    }
+    if (sc.csv)
+        fclose(sc.csv);
+    free(sc.series);
+    free((float *)sc.samples);
+    pthread_mutex_destroy(&sc.lock);
+    return ret;
+}
@@ -0,0 +1,626 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Cold start latency per phase. Every run is a fresh process, like an app
+ * start: the parent forks and re-executes itself, the child loads the model
+ * and reports its phase times back through a pipe. */
+
+#include "audio.h"
+#include "stream.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ggml-backend.h"
+
+/* Relative to lib/src/main/jni, where the Makefile lives */
+#define DEFAULT_MODELS_DIR "../../../../models_pack/src/main/assets/models"
+#define DEFAULT_CORPUS     "../../../../app/src/androidTest/assets/test_long_273s.opus"
+#define DEFAULT_VAD_MODEL  "ggml-silero-v6.2.0.bin"
+
+#define MAX_MODELS 16
+
+enum startup_mode
+{
+    MODE_CPU,
+    MODE_GPU,
+    MODE_COUNT
+};
+
+static const char *const mode_names[MODE_COUNT] = { "CPU", "GPU" };
+
+/* In process order. The library load of the app is the dynamic linking
+ * before main(), the pipeline compile is the first encode minus the second. */
+enum startup_phase
+{
+    PHASE_EXEC,         /* fork to main(), dynamic linking included */
+    PHASE_BACKEND,      /* ggml backend registry and device init */
+    PHASE_READ,         /* model file reads */
+    PHASE_INIT,         /* rest of the model init: tensors, buffers, upload */
+    PHASE_VAD,          /* VAD model init */
+    PHASE_MEL,          /* first log-mel spectrogram */
+    PHASE_COMPILE,      /* first encode minus a warm one: graph and pipelines */
+    PHASE_ENCODE,       /* warm encode */
+    PHASE_DECODE,       /* first decoder pass over the start of transcript */
+    PHASE_SEGMENT,      /* whisper_stream_full() start to the first segment, fresh context */
+    PHASE_COUNT
+};
+
+static const char *const phase_names[PHASE_COUNT] = {
+    "exec", "backend", "read", "init", "vad", "mel", "compile", "encode", "decode",
+    "first_segment",
+};
+
+/* Written by the child as is, both sides run the same binary */
+struct startup_run
+{
+    int ok;
+    double ms[PHASE_COUNT];
+};
+
+struct bench_stat
+{
+    double mean;
+    double ci;      /* 95% confidence half-width, 0 for a single run */
+};
+
+struct timed_file
+{
+    FILE *f;
+    int64_t read_us;
+};
+
+struct first_segment
+{
+    int64_t t_us;
+    bool done;
+};
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+log_disable(enum ggml_log_level level, const char *text, void *user_data)
+{
+    (void)level;
+    (void)text;
+    (void)user_data;
+}
+
+/* Same reads as whisper_init_from_file_with_params(), timed */
+static size_t
+timed_read(void *ctx, void *output, size_t read_size)
+{
+    struct timed_file *tf = ctx;
+    int64_t t0 = now_us();
+    size_t ret = fread(output, 1, read_size, tf->f);
+    tf->read_us += now_us() - t0;
+    return ret;
+}
+
+static bool
+timed_eof(void *ctx)
+{
+    struct timed_file *tf = ctx;
+    return feof(tf->f);
+}
+
+static void
+timed_close(void *ctx)
+{
+    struct timed_file *tf = ctx;
+    fclose(tf->f);
+    tf->f = NULL;
+}
+
+static void
+segment_cb(struct whisper_context *ctx, const struct whisper_stream_segment *seg,
+           void *user_data)
+{
+    (void)ctx;
+    (void)seg;
+    struct first_segment *fs = user_data;
+    if (!fs->done)
+    {
+        fs->t_us = now_us();
+        fs->done = true;
+    }
+}
+
+static bool
+abort_cb(void *user_data)
+{
+    const struct first_segment *fs = user_data;
+    return fs->done;
+}
+
+static struct whisper_context *
+load_model(const char *model_path, bool gpu, int64_t *read_us)
+{
+    struct timed_file tf = { fopen(model_path, "rb"), 0 };
+    if (!tf.f)
+    {
+        fprintf(stderr, "Failed to open %s: %s\n", model_path, strerror(errno));
+        return NULL;
+    }
+
+    whisper_model_loader loader = {
+        .context = &tf,
+        .read = timed_read,
+        .eof = timed_eof,
+        .close = timed_close,
+    };
+
+    struct whisper_context_params cparams = whisper_context_default_params();
+    cparams.flash_attn = cparams.use_gpu = gpu;
+    struct whisper_context *ctx = whisper_init_with_params(&loader, cparams);
+    if (tf.f)
+        fclose(tf.f);
+    *read_us = tf.read_us;
+    return ctx;
+}
+
+/* The child: one cold start, phases in process order */
+static int
+run_child(int fd, int64_t t_fork, const char *model_path, const char *vad_path,
+          bool gpu, int n_threads, const char *audio_path)
+{
+    struct startup_run run;
+    int64_t t_main = now_us();
+    memset(&run, 0, sizeof run);
+    run.ms[PHASE_EXEC] = (t_main - t_fork) / 1000.0;
+
+    whisper_log_set(log_disable, NULL);
+
+    struct whisper_context *ctx = NULL, *ctx2 = NULL;
+    struct whisper_vad_context *vad = NULL;
+    float *samples = NULL;
+
+    int64_t t0 = now_us();
+    if (ggml_backend_dev_count() == 0)
+        goto done;
+    run.ms[PHASE_BACKEND] = (now_us() - t0) / 1000.0;
+
+    int64_t read_us;
+    t0 = now_us();
+    ctx = load_model(model_path, gpu, &read_us);
+    if (!ctx)
+        goto done;
+    run.ms[PHASE_READ] = read_us / 1000.0;
+    run.ms[PHASE_INIT] = (now_us() - t0 - read_us) / 1000.0;
+
+    struct whisper_vad_context_params vp = whisper_vad_default_context_params();
+    vp.n_threads = 1;
+    vp.use_gpu = false;
+    t0 = now_us();
+    vad = whisper_vad_init_from_file_with_params(vad_path, vp);
+    if (!vad)
+        goto done;
+    run.ms[PHASE_VAD] = (now_us() - t0) / 1000.0;
+
+    /* Not a phase of the app, it decodes while the model loads */
+    int n_samples;
+    samples = read_avcodec(audio_path, &n_samples);
+    if (!samples)
+        goto done;
+    int n_window = n_samples < 30 * WHISPER_SAMPLE_RATE ? n_samples : 30 * WHISPER_SAMPLE_RATE;
+
+    t0 = now_us();
+    if (whisper_pcm_to_mel(ctx, samples, n_window, n_threads) != 0)
+        goto done;
+    run.ms[PHASE_MEL] = (now_us() - t0) / 1000.0;
+
+    t0 = now_us();
+    if (whisper_encode(ctx, 0, n_threads) != 0)
+        goto done;
+    double first_encode = (now_us() - t0) / 1000.0;
+    t0 = now_us();
+    if (whisper_encode(ctx, 0, n_threads) != 0)
+        goto done;
+    run.ms[PHASE_ENCODE] = (now_us() - t0) / 1000.0;
+    run.ms[PHASE_COMPILE] = fmax(first_encode - run.ms[PHASE_ENCODE], 0);
+
+    whisper_token sot = whisper_token_sot(ctx);
+    t0 = now_us();
+    if (whisper_decode(ctx, &sot, 1, 0, n_threads) != 0)
+        goto done;
+    run.ms[PHASE_DECODE] = (now_us() - t0) / 1000.0;
+
+    /* The app path on a context that has not run yet. Backend and shader
+     * caches are process wide and stay warm, file pages too. */
+    ctx2 = load_model(model_path, gpu, &read_us);
+    if (!ctx2)
+        goto done;
+
+    struct first_segment fs = { 0, false };
+    struct file_ctx fctx = { samples, n_samples, 0 };
+
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.language = "en";
+    wparams.suppress_nst = true;
+
+    struct whisper_stream_params sparams = whisper_stream_default_params();
+    sparams.slots[0].ctx = ctx2;
+    sparams.slots[0].vad_ctx = vad;
+    sparams.slots[0].num_threads = n_threads;
+    sparams.read_callback = file_read_cb;
+    sparams.read_callback_user_data = &fctx;
+    sparams.segment_callback = segment_cb;
+    sparams.segment_callback_user_data = &fs;
+    sparams.abort_callback = abort_cb;
+    sparams.abort_callback_user_data = &fs;
+
+    t0 = now_us();
+    whisper_stream_full(wparams, sparams);
+    if (!fs.done)
+        goto done;
+    run.ms[PHASE_SEGMENT] = (fs.t_us - t0) / 1000.0;
+    run.ok = 1;
+
+done:
+    if (!run.ok)
+        fprintf(stderr, "Startup run failed: %s %s\n", model_path, gpu ? "GPU" : "CPU");
+    free(samples);
+    if (vad)
+        whisper_vad_free(vad);
+    if (ctx2)
+        whisper_free(ctx2);
+    if (ctx)
+        whisper_free(ctx);
+
+    ssize_t written = write(fd, &run, sizeof run);
+    close(fd);
+    return written == (ssize_t)sizeof run && run.ok ? 0 : 1;
+}
+
+static void
+drop_caches(void)
+{
+    static bool warned;
+
+    sync();
+    int fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+    if (fd >= 0 && write(fd, "3", 1) == 1)
+    {
+        close(fd);
+        return;
+    }
+    if (fd >= 0)
+        close(fd);
+    if (!warned)
+        fprintf(stderr, "Cannot drop the page cache (root only), model reads are warm\n");
+    warned = true;
+}
+
+/* Re-executes this binary, so that every run pays the dynamic linking */
+static int
+spawn_run(const char *model_path, const char *vad_path, bool gpu, int n_threads,
+          const char *audio_path, struct startup_run *run)
+{
+    int fds[2];
+    if (pipe(fds) < 0)
+        return -1;
+
+    char fd_arg[16], fork_arg[32], threads_arg[16];
+    snprintf(fd_arg, sizeof fd_arg, "%d", fds[1]);
+    snprintf(threads_arg, sizeof threads_arg, "%d", n_threads);
+
+    int64_t t_fork = now_us();
+    snprintf(fork_arg, sizeof fork_arg, "%lld", (long long)t_fork);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        char *args[] = {
+            "startup_bench", "--child", fd_arg, fork_arg, (char *)model_path,
+            (char *)vad_path, gpu ? "1" : "0", threads_arg, (char *)audio_path, NULL
+        };
+        execv("/proc/self/exe", args);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    ssize_t n = read(fds[0], run, sizeof *run);
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (n != (ssize_t)sizeof *run || !run->ok)
+        return -1;
+    return 0;
+}
+
+/* Two-sided 95% Student t critical values, df 1..30 */
+static const double t95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+static struct bench_stat
+compute_stat(const double *values, int n)
+{
+    struct bench_stat st = { 0, 0 };
+    if (n <= 0)
+        return st;
+
+    for (int i = 0; i < n; i++)
+        st.mean += values[i];
+    st.mean /= n;
+
+    if (n < 2)
+        return st;
+
+    double var = 0;
+    for (int i = 0; i < n; i++)
+        var += (values[i] - st.mean) * (values[i] - st.mean);
+    var /= n - 1;
+
+    int df = n - 1;
+    double t = df <= (int)(sizeof t95 / sizeof t95[0]) ? t95[df - 1] : 1.960;
+    st.ci = t * sqrt(var / n);
+    return st;
+}
+
+/* "ggml-small-q8_0.bin" -> "small", like WhisperBenchmark */
+static void
+model_display_name(const char *path, char *out, size_t size)
+{
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    if (strncmp(base, "ggml-", 5) == 0)
+        base += 5;
+
+    size_t len = strcspn(base, ".");
+    const char *q = strstr(base, "-q");
+    if (q && (size_t)(q - base) < len)
+        len = q - base;
+    snprintf(out, size, "%.*s", (int)len, base);
+}
+
+/* Every ggml-*.bin of dir but the VAD models, returns the count */
+static int
+list_models(const char *dir, char **out, int max_out)
+{
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        fprintf(stderr, "Failed to open models directory: %s\n", dir);
+        return -1;
+    }
+
+    int n = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL && n < max_out)
+    {
+        const char *name = e->d_name;
+        size_t len = strlen(name);
+        if (strncmp(name, "ggml-", 5) != 0 || len < 4 || strcmp(name + len - 4, ".bin") != 0
+            || strstr(name, "silero"))
+            continue;
+        out[n] = malloc(strlen(dir) + len + 2);
+        if (!out[n])
+            break;
+        sprintf(out[n], "%s/%s", dir, name);
+        n++;
+    }
+    closedir(d);
+    return n;
+}
+
+static int
+parse_modes(const char *list, bool modes[MODE_COUNT])
+{
+    memset(modes, 0, MODE_COUNT * sizeof *modes);
+
+    while (*list)
+    {
+        size_t len = strcspn(list, ",");
+        int m;
+        for (m = 0; m < MODE_COUNT; m++)
+        {
+            if (strlen(mode_names[m]) == len && strncasecmp(list, mode_names[m], len) == 0)
+                break;
+        }
+        if (m == MODE_COUNT)
+        {
+            fprintf(stderr, "Unknown mode: %.*s\n", (int)len, list);
+            return -1;
+        }
+        modes[m] = true;
+        list += len;
+        if (*list == ',')
+            list++;
+    }
+    return 0;
+}
+
+static int
+bench_startup(const char *model_path, const char *vad_path, enum startup_mode mode,
+              int n_threads, const char *audio_path, int reps, bool cold)
+{
+    char model_name[64];
+    model_display_name(model_path, model_name, sizeof model_name);
+
+    double *values = calloc((size_t)reps * (PHASE_COUNT + 1), sizeof *values);
+    if (!values)
+        return -1;
+
+    int n = 0;
+    for (int i = 0; i < reps; i++)
+    {
+        struct startup_run run;
+        if (cold)
+            drop_caches();
+        if (spawn_run(model_path, vad_path, mode == MODE_GPU, n_threads, audio_path, &run) < 0)
+        {
+            fprintf(stderr, "%s %s: run %d failed\n", model_name, mode_names[mode], i);
+            continue;
+        }
+
+        double total = 0;
+        fprintf(stderr, "%s %s %d:", model_name, mode_names[mode], i);
+        for (int p = 0; p < PHASE_COUNT; p++)
+        {
+            values[p * reps + n] = run.ms[p];
+            total += run.ms[p];
+            fprintf(stderr, " %s=%.0fms", phase_names[p], run.ms[p]);
+        }
+        values[PHASE_COUNT * reps + n] = total;
+        fprintf(stderr, " total=%.0fms\n", total);
+        n++;
+    }
+
+    if (n == 0)
+    {
+        free(values);
+        return -1;
+    }
+
+    printf("STARTUP: %s | %s | %d threads | %s", model_name, mode_names[mode], n_threads,
+           cold ? "cold" : "warm");
+    for (int p = 0; p <= PHASE_COUNT; p++)
+    {
+        struct bench_stat st = compute_stat(&values[p * reps], n);
+        printf(" | %s=%.0fms±%.0f", p < PHASE_COUNT ? phase_names[p] : "total", st.mean, st.ci);
+    }
+    printf(" | n=%d\n", n);
+    fflush(stdout);
+
+    free(values);
+    return n == reps ? 0 : -1;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options] [audio file]\n", prog);
+    fprintf(stderr, "  -d, --models DIR      Models directory (default: %s)\n", DEFAULT_MODELS_DIR);
+    fprintf(stderr, "  -m, --model PATH      Model path, repeatable (default: every model of --models)\n");
+    fprintf(stderr, "  -v, --vad-model NAME  VAD model in --models (default: %s)\n", DEFAULT_VAD_MODEL);
+    fprintf(stderr, "  -M, --modes LIST      cpu,gpu (default: cpu,gpu)\n");
+    fprintf(stderr, "  -t, --threads N       CPU threads (default: all cores, 1 for GPU)\n");
+    fprintf(stderr, "  -r, --reps N          Runs per model and mode (default: 5)\n");
+    fprintf(stderr, "  -c, --cold            Drop the page cache before every run (root only)\n");
+    fprintf(stderr, "Audio defaults to %s\n", DEFAULT_CORPUS);
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc == 9 && strcmp(argv[1], "--child") == 0)
+    {
+        return run_child(atoi(argv[2]), atoll(argv[3]), argv[4], argv[5],
+                         strcmp(argv[6], "1") == 0, atoi(argv[7]), argv[8]);
+    }
+
+    const char *models_dir = DEFAULT_MODELS_DIR;
+    const char *vad_model = DEFAULT_VAD_MODEL;
+    const char *mode_list = "cpu,gpu";
+    char *models[MAX_MODELS];
+    int n_models = 0;
+    int n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int reps = 5;
+    bool cold = false;
+
+    static struct option long_opts[] = {
+        {"models",    required_argument, 0, 'd'},
+        {"model",     required_argument, 0, 'm'},
+        {"vad-model", required_argument, 0, 'v'},
+        {"modes",     required_argument, 0, 'M'},
+        {"threads",   required_argument, 0, 't'},
+        {"reps",      required_argument, 0, 'r'},
+        {"cold",      no_argument,       0, 'c'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:m:v:M:t:r:c", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': models_dir = optarg; break;
+        case 'm':
+            if (n_models == MAX_MODELS)
+            {
+                fprintf(stderr, "At most %d models\n", MAX_MODELS);
+                return 1;
+            }
+            models[n_models++] = strdup(optarg);
+            break;
+        case 'v': vad_model = optarg; break;
+        case 'M': mode_list = optarg; break;
+        case 't': n_threads = atoi(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case 'c': cold = true; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bool modes[MODE_COUNT];
+    if (parse_modes(mode_list, modes) < 0)
+        return 1;
+    if (n_threads < 1)
+        n_threads = 1;
+    if (reps < 1)
+    {
+        fprintf(stderr, "reps must be >= 1\n");
+        return 1;
+    }
+
+    if (n_models == 0)
+        n_models = list_models(models_dir, models, MAX_MODELS);
+    if (n_models <= 0)
+    {
+        fprintf(stderr, "No models\n");
+        return 1;
+    }
+
+    const char *audio_path = optind < argc ? argv[optind] : DEFAULT_CORPUS;
+    char *vad_path = malloc(strlen(models_dir) + strlen(vad_model) + 2);
+    if (!vad_path)
+        return 1;
+    sprintf(vad_path, "%s/%s", models_dir, vad_model);
+
+    int ret = 0;
+    for (int i = 0; i < n_models; i++)
+    {
+        for (int m = 0; m < MODE_COUNT; m++)
+        {
+            if (!modes[m])
+                continue;
+            int threads = m == MODE_GPU ? 1 : n_threads;
+            if (bench_startup(models[i], vad_path, m, threads, audio_path, reps, cold) < 0)
+                ret = 1;
+        }
+        free(models[i]);
+    }
+
+    free(vad_path);
+    return ret;
+}
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <stdatomic.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -27,6 +28,14 @@
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
+/* The per chunk path takes `single` as a constant and is instantiated once
+ * per mode, see process_chunk_single() and process_chunk_dual(): the single
+ * slot instance has no locking left in it */
+#define STREAM_SPECIALIZED static inline __attribute__((always_inline))
+
+/* Weight of the last chunk in the smoothed RTF */
+#define RTF_SMOOTHING 0.3f
+
 struct chunk_info
 {
     int chunk_samples;
@@ -67,13 +76,22 @@ struct common_ctx
     whisper_stream_progress_callback progress_cb;
     void *progress_cb_user_data;
 
+    whisper_stream_duration_callback duration_cb;
+    void *duration_cb_user_data;
+
     whisper_stream_language_callback language_cb;
     void *language_cb_user_data;
 
     whisper_stream_abort_callback abort_cb;
     void *abort_cb_user_data;
 
+    whisper_stream_chunk_callback chunk_cb;
+    void *chunk_cb_user_data;
+
     atomic_uintptr_t progress_reporter;
+
+    struct whisper_stream_mem_stats mem;
+    struct whisper_stream_stats *stats_out;
 };
 
 struct thread_ctx
@@ -99,9 +117,77 @@ struct thread_ctx
 
     int64_t samples_before_chunk;
     int chunk_samples;
+    int chunk_idx;
+    int64_t cut_us;
+
+    /* Read by the other slot when reporting progress */
+    _Atomic float rtf;
+    int64_t cycle_start_us;
+
+    struct whisper_stream_slot_stats stats;
 };
 
 
+static const char *const mem_names[WHISPER_STREAM_MEM_COUNT] = {
+    [WHISPER_STREAM_MEM_WEIGHTS] = "weights",
+    [WHISPER_STREAM_MEM_KV]      = "kv",
+    [WHISPER_STREAM_MEM_COMPUTE] = "compute",
+    [WHISPER_STREAM_MEM_AUDIO]   = "audio",
+    [WHISPER_STREAM_MEM_TOKENS]  = "tokens",
+    [WHISPER_STREAM_MEM_VAD]     = "vad",
+};
+
+static const char *const time_names[WHISPER_STREAM_TIME_COUNT] = {
+    [WHISPER_STREAM_TIME_BUSY]    = "busy",
+    [WHISPER_STREAM_TIME_TURN]    = "turn",
+    [WHISPER_STREAM_TIME_CONTEXT] = "context",
+    [WHISPER_STREAM_TIME_READ]    = "read",
+};
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+add_stall(struct thread_ctx *tctx, enum whisper_stream_time cls,
+          int64_t start_us)
+{
+    tctx->stats.time_us[cls] += now_us() - start_us;
+}
+
+static void
+mem_set(struct whisper_stream_mem_stats *mem, enum whisper_stream_mem cls,
+        size_t bytes)
+{
+    mem->cur[cls] = bytes;
+    if (bytes > mem->max[cls])
+        mem->max[cls] = bytes;
+}
+
+/* Sample whisper and VAD allocations, they can grow on the first chunks.
+ * Without the getters of WHISPER_MEM_USAGE these classes stay at 0. */
+static void
+update_slot_mem(struct thread_ctx *tctx)
+{
+#ifdef WHISPER_MEM_USAGE
+    struct whisper_stream_mem_stats *mem = &tctx->stats.mem;
+    struct whisper_mem_usage usage;
+
+    whisper_ctx_get_mem_usage(tctx->ctx, &usage);
+    mem_set(mem, WHISPER_STREAM_MEM_WEIGHTS, usage.weights);
+    mem_set(mem, WHISPER_STREAM_MEM_KV, usage.kv);
+    mem_set(mem, WHISPER_STREAM_MEM_COMPUTE, usage.compute);
+    mem_set(mem, WHISPER_STREAM_MEM_VAD,
+            whisper_vad_get_mem_usage(tctx->vad_ctx));
+#else
+    (void)tctx;
+#endif
+}
+
 static bool
 stream_abort_callback(void *user_data)
 {
@@ -143,12 +229,55 @@ stream_segment_callback(struct whisper_context *ctx, struct whisper_state *state
         if (t0 >= t1)
             continue;
 
-        tctx->segment_cb(ctx, t0, t1, whisper_full_get_segment_text(ctx, i),
-                         tctx->segment_cb_user_data);
+        struct whisper_stream_segment seg = {
+            .t0 = t0,
+            .t1 = t1,
+            .text = whisper_full_get_segment_text(ctx, i),
+            .lang_id = whisper_full_lang_id(ctx),
+            .slot = tctx->parity,
+            .chunk_idx = tctx->chunk_idx,
+            .latency_us = now_us() - tctx->cut_us,
+        };
+        tctx->segment_cb(ctx, &seg, tctx->segment_cb_user_data);
         tctx->last_t1 = t1;
     }
 }
 
+/* Time from the end of the previous chunk of this slot, stalls included,
+ * so that summing slot speeds gives the stream throughput */
+static void
+update_rtf(struct thread_ctx *tctx, int chunk_samples)
+{
+    int64_t now = now_us();
+    int64_t elapsed_us = now - tctx->cycle_start_us;
+    tctx->cycle_start_us = now;
+
+    if (chunk_samples <= 0)
+        return;
+
+    float rtf = elapsed_us / (chunk_samples * 1e6f / WHISPER_SAMPLE_RATE);
+    float avg = atomic_load(&tctx->rtf);
+    avg = avg > 0 ? avg + RTF_SMOOTHING * (rtf - avg) : rtf;
+    atomic_store(&tctx->rtf, avg);
+}
+
+static float
+stream_speed(struct thread_ctx *tctx)
+{
+    float speed = 0;
+    struct thread_ctx *slots[2] = { tctx, tctx->other_tctx };
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (!slots[i])
+            continue;
+        float rtf = atomic_load(&slots[i]->rtf);
+        if (rtf > 0)
+            speed += 1.0f / rtf;
+    }
+    return speed;
+}
+
 static void
 stream_progress_callback(struct whisper_context *ctx, struct whisper_state *state,
                          int progress, void *user_data)
@@ -162,9 +291,29 @@ stream_progress_callback(struct whisper_context *ctx, struct whisper_state *stat
     if ((uintptr_t)tctx != atomic_load(&cctx->progress_reporter))
         return;
 
-    if (cctx->progress_cb)
-        cctx->progress_cb(progress, tctx->samples_before_chunk,
-                          tctx->chunk_samples, cctx->progress_cb_user_data);
+    if (!cctx->progress_cb)
+        return;
+
+    struct whisper_stream_progress p;
+    p.chunk_progress = progress;
+    p.samples_before = tctx->samples_before_chunk;
+    p.chunk_samples = tctx->chunk_samples;
+    p.samples_done = p.samples_before
+                   + ((int64_t)progress * p.chunk_samples) / 100;
+    p.samples_total = cctx->duration_cb
+                    ? cctx->duration_cb(cctx->duration_cb_user_data) : 0;
+    p.speed = stream_speed(tctx);
+    p.eta_ms = -1;
+
+    if (p.samples_total > 0 && p.speed > 0)
+    {
+        int64_t remaining = p.samples_total - p.samples_done;
+        if (remaining < 0)
+            remaining = 0;
+        p.eta_ms = (int64_t)(remaining * 1000.0 / WHISPER_SAMPLE_RATE / p.speed);
+    }
+
+    cctx->progress_cb(&p, cctx->progress_cb_user_data);
 }
 
 static int
@@ -194,24 +343,33 @@ copy_tokens(struct thread_ctx *tctx, whisper_token *tokens_out,
     return n;
 }
 
+/* The slot's own context, passed by the previous chunk on the same thread */
 static int
-stream_context_callback(struct whisper_context *ctx, struct whisper_state *state,
-                        whisper_token *tokens_out, int max_tokens,
-                        int *lang_id_out, void *user_data)
+stream_context_callback_single(struct whisper_context *ctx, struct whisper_state *state,
+                               whisper_token *tokens_out, int max_tokens,
+                               int *lang_id_out, void *user_data)
+{
+    (void)ctx;
+    (void)state;
+    return copy_tokens(user_data, tokens_out, max_tokens, lang_id_out);
+}
+
+/* Waits for the other slot to finish the previous chunk */
+static int
+stream_context_callback_dual(struct whisper_context *ctx, struct whisper_state *state,
+                             whisper_token *tokens_out, int max_tokens,
+                             int *lang_id_out, void *user_data)
 {
     (void)ctx;
     (void)state;
     struct thread_ctx *tctx = user_data;
     struct common_ctx *cctx = tctx->cctx;
 
-    if (cctx->single_thread)
-    {
-        return copy_tokens(tctx, tokens_out, max_tokens, lang_id_out);
-    }
-
+    int64_t start_us = now_us();
     pthread_mutex_lock(&cctx->mutex);
     while (!tctx->context_ready && !atomic_load(&cctx->abort))
         pthread_cond_wait(&cctx->cond, &cctx->mutex);
+    add_stall(tctx, WHISPER_STREAM_TIME_CONTEXT, start_us);
 
     tctx->context_ready = false;
 
@@ -310,16 +468,17 @@ find_silence_in_segments(struct whisper_vad_segments *segs,
                      min_silence_ms);
 }
 
-static void
-pass_context(struct thread_ctx *tctx)
+STREAM_SPECIALIZED void
+pass_context(struct thread_ctx *tctx, const bool single)
 {
     struct common_ctx *cctx = tctx->cctx;
-    struct thread_ctx *dst = cctx->single_thread ? tctx : tctx->other_tctx;
-
-    atomic_store(&cctx->progress_reporter, (uintptr_t)dst);
+    struct thread_ctx *dst = single ? tctx : tctx->other_tctx;
 
-    if (!cctx->single_thread)
+    if (!single)
+    {
+        atomic_store(&cctx->progress_reporter, (uintptr_t)dst);
         pthread_mutex_lock(&cctx->mutex);
+    }
 
     int n = whisper_full_get_prompt_past(tctx->ctx, dst->tokens,
                                          cctx->max_ctx_tokens);
@@ -328,7 +487,7 @@ pass_context(struct thread_ctx *tctx)
     dst->lang_id = whisper_full_lang_id(tctx->ctx);
     dst->context_ready = true;
 
-    if (!cctx->single_thread)
+    if (!single)
     {
         pthread_cond_signal(&cctx->cond);
         pthread_mutex_unlock(&cctx->mutex);
@@ -403,24 +562,28 @@ fill_read_buffer(struct common_ctx *cctx, int target_len, bool *eof)
     return buffer_len;
 }
 
-static void
-set_eof(struct common_ctx *cctx, bool and_abort)
+STREAM_SPECIALIZED void
+set_eof(struct common_ctx *cctx, const bool single, bool and_abort)
 {
-    pthread_mutex_lock(&cctx->mutex);
+    if (!single)
+        pthread_mutex_lock(&cctx->mutex);
     cctx->eof = true;
     if (and_abort)
         atomic_store(&cctx->abort, true);
-    pthread_cond_signal(&cctx->cond);
-    pthread_mutex_unlock(&cctx->mutex);
+    if (!single)
+    {
+        pthread_cond_signal(&cctx->cond);
+        pthread_mutex_unlock(&cctx->mutex);
+    }
 }
 
-static int
-wait_for_turn(struct thread_ctx *tctx, int *chunk_idx_out,
+STREAM_SPECIALIZED int
+wait_for_turn(struct thread_ctx *tctx, const bool single, int *chunk_idx_out,
               int64_t *total_samples_out)
 {
     struct common_ctx *cctx = tctx->cctx;
 
-    if (cctx->single_thread)
+    if (single)
     {
         if (cctx->eof)
             return -1;
@@ -430,9 +593,11 @@ wait_for_turn(struct thread_ctx *tctx, int *chunk_idx_out,
         return cctx->read_buffer_len;
     }
 
+    int64_t start_us = now_us();
     pthread_mutex_lock(&cctx->mutex);
     while ((cctx->next_chunk_idx % 2 != tctx->parity) && !cctx->eof)
         pthread_cond_wait(&cctx->cond, &cctx->mutex);
+    add_stall(tctx, WHISPER_STREAM_TIME_TURN, start_us);
 
     if (cctx->eof)
     {
@@ -447,21 +612,33 @@ wait_for_turn(struct thread_ctx *tctx, int *chunk_idx_out,
     return len;
 }
 
-static void
-handoff_to_next(struct common_ctx *cctx, struct chunk_info *ci,
+/* The chunk starts the read buffer, so the slot takes that buffer whole and
+ * reading goes on in the slot's previous one, which it no longer uses: only
+ * the overlap and the read-ahead are copied. Each buffer belongs to the read
+ * side or to one slot at a time, and the swap is under the mutex the next
+ * slot takes before it reads. Returns the number of samples left in the read
+ * buffer. */
+STREAM_SPECIALIZED int
+handoff_to_next(struct thread_ctx *tctx, const bool single, struct chunk_info *ci,
                 int64_t total_samples, int chunk_idx, bool is_eof)
 {
-    if (!cctx->single_thread)
+    struct common_ctx *cctx = tctx->cctx;
+
+    if (!single)
         pthread_mutex_lock(&cctx->mutex);
 
+    float *chunk = cctx->read_buffer;
+    cctx->read_buffer = tctx->buffer;
+    tctx->buffer = chunk;
+
     int keep_start = ci->actual_chunk_samples - cctx->overlap_samples;
     if (keep_start < 0)
         keep_start = 0;
     int keep_len = cctx->read_buffer_len - keep_start;
     if (keep_len > 0)
     {
-        memmove(cctx->read_buffer, cctx->read_buffer + keep_start,
-                keep_len * sizeof *cctx->read_buffer);
+        memcpy(cctx->read_buffer, chunk + keep_start,
+               keep_len * sizeof *cctx->read_buffer);
         cctx->read_buffer_len = keep_len;
     }
     else
@@ -474,24 +651,53 @@ handoff_to_next(struct common_ctx *cctx, struct chunk_info *ci,
     /* Only overlap data remains - nothing new to transcribe */
     if (is_eof && keep_len <= cctx->overlap_samples)
         cctx->eof = true;
+    int queued = cctx->read_buffer_len;
 
-    if (!cctx->single_thread)
+    if (!single)
     {
         pthread_cond_signal(&cctx->cond);
         pthread_mutex_unlock(&cctx->mutex);
     }
+    return queued;
 }
 
-static int
-process_one_chunk(struct thread_ctx *tctx)
+static void
+report_chunk(struct thread_ctx *tctx, struct whisper_stream_chunk_stats *chunk,
+             const int64_t *stalls_before, int64_t start_us)
+{
+    struct common_ctx *cctx = tctx->cctx;
+
+    if (!cctx->chunk_cb)
+        return;
+
+    int64_t busy_us = now_us() - start_us;
+    for (int i = 0; i < WHISPER_STREAM_TIME_COUNT; i++)
+    {
+        if (i == WHISPER_STREAM_TIME_BUSY)
+            continue;
+        chunk->time_us[i] = tctx->stats.time_us[i] - stalls_before[i];
+        busy_us -= chunk->time_us[i];
+    }
+    chunk->time_us[WHISPER_STREAM_TIME_BUSY] = busy_us > 0 ? busy_us : 0;
+    chunk->mem = tctx->stats.mem;
+
+    cctx->chunk_cb(chunk, cctx->chunk_cb_user_data);
+}
+
+STREAM_SPECIALIZED int
+process_one_chunk(struct thread_ctx *tctx, const bool single)
 {
     struct common_ctx *cctx = tctx->cctx;
     int target_len = cctx->max_chunk_samples + cctx->overlap_samples;
 
     int chunk_idx;
     int64_t total_samples;
+    int64_t chunk_start_us = now_us();
+    int64_t stalls_before[WHISPER_STREAM_TIME_COUNT];
 
-    if (wait_for_turn(tctx, &chunk_idx, &total_samples) < 0)
+    memcpy(stalls_before, tctx->stats.time_us, sizeof stalls_before);
+
+    if (wait_for_turn(tctx, single, &chunk_idx, &total_samples) < 0)
         return -1;
 
     int overlap_offset = (chunk_idx > 0) ? cctx->overlap_samples : 0;
@@ -499,10 +705,14 @@ process_one_chunk(struct thread_ctx *tctx)
     int buffer_len;
     struct whisper_vad_segments *vad_segs = NULL;
     int found_boundary = -1;
+    enum whisper_stream_cut cut = WHISPER_STREAM_CUT_END;
 
+    int64_t read_start_us = now_us();
     buffer_len = fill_read_buffer(cctx, target_len, &eof);
+    add_stall(tctx, WHISPER_STREAM_TIME_READ, read_start_us);
 
     int vad_start = 0;
+    int64_t vad_start_us = now_us();
     if (tctx->vad_ctx)
     {
         /* Start VAD 5s before search range to establish state */
@@ -527,6 +737,11 @@ process_one_chunk(struct thread_ctx *tctx)
         int silence_found;
         found_boundary = find_chunk_boundary(tctx, available, vad_segs,
                                              vad_start, &silence_found);
+        if (silence_found > 0)
+            cut = WHISPER_STREAM_CUT_SILENCE;
+        else if (!eof || found_boundary < available)
+            cut = WHISPER_STREAM_CUT_FORCED;
+
         if (silence_found > 0)
             TCTX_LOGI(tctx, "silence >=%dms at %dms\n", silence_found,
                       (found_boundary * 1000) / WHISPER_SAMPLE_RATE);
@@ -541,10 +756,11 @@ process_one_chunk(struct thread_ctx *tctx)
 
     if (vad_segs)
         whisper_vad_free_segments(vad_segs);
+    int64_t vad_us = now_us() - vad_start_us;
 
     if (buffer_len <= overlap_offset)
     {
-        set_eof(cctx, false);
+        set_eof(cctx, single, false);
         return -1;
     }
 
@@ -562,13 +778,12 @@ process_one_chunk(struct thread_ctx *tctx)
               ci.actual_chunk_samples - cctx->overlap_samples,
               (long long)total_samples);
 
-    memcpy(tctx->buffer, cctx->read_buffer,
-           ci.actual_chunk_samples * sizeof *tctx->buffer);
-
     tctx->samples_before_chunk = total_samples;
     tctx->chunk_samples = ci.chunk_samples;
+    tctx->chunk_idx = chunk_idx;
+    tctx->cut_us = now_us();
 
-    handoff_to_next(cctx, &ci, total_samples, chunk_idx, eof);
+    int queued = handoff_to_next(tctx, single, &ci, total_samples, chunk_idx, eof);
 
     tctx->time_offset = ci.time_offset;
     tctx->output_start = ci.time_offset
@@ -590,7 +805,8 @@ process_one_chunk(struct thread_ctx *tctx)
 
     if (chunk_idx > 0)
     {
-        params.context_callback = stream_context_callback;
+        params.context_callback = single ? stream_context_callback_single
+                                         : stream_context_callback_dual;
         params.context_callback_user_data = tctx;
     }
 
@@ -600,32 +816,99 @@ process_one_chunk(struct thread_ctx *tctx)
     params.vad = true;
 
     TCTX_LOGI(tctx, "chunk %d: start\n", chunk_idx);
+    int64_t transcribe_start_us = now_us();
     int ret = whisper_full(tctx->ctx, params, tctx->buffer,
                            ci.actual_chunk_samples);
+    int64_t transcribe_us = now_us() - transcribe_start_us;
     TCTX_LOGI(tctx, "chunk %d: done: %d\n", chunk_idx, ret);
 
+    update_slot_mem(tctx);
+    if (ret == 0)
+        update_rtf(tctx, ci.chunk_samples);
+
+    struct whisper_stream_chunk_stats chunk = {
+        .slot = tctx->parity,
+        .chunk_idx = chunk_idx,
+        .samples = ci.chunk_samples,
+        .queued_samples = queued,
+        .result = ret,
+        .cut = cut,
+        .vad_us = vad_us,
+        .transcribe_us = transcribe_us,
+    };
+    report_chunk(tctx, &chunk, stalls_before, chunk_start_us);
+
     bool aborted = false;
     if (cctx->abort_cb != NULL && cctx->abort_cb(cctx->abort_cb_user_data))
         aborted = true;
 
     if (ret != 0 || aborted)
     {
-        set_eof(cctx, true);
+        set_eof(cctx, single, true);
         return ret;
     }
 
-    pass_context(tctx);
+    pass_context(tctx, single);
 
     return 0;
 }
 
+static int
+process_chunk_single(struct thread_ctx *tctx)
+{
+    return process_one_chunk(tctx, true);
+}
+
+static int
+process_chunk_dual(struct thread_ctx *tctx)
+{
+    return process_one_chunk(tctx, false);
+}
+
+static void
+run_slot(struct thread_ctx *tctx)
+{
+    int64_t start_us = now_us();
+    tctx->cycle_start_us = start_us;
+
+    int (*process)(struct thread_ctx *) = tctx->cctx->single_thread
+                                        ? process_chunk_single : process_chunk_dual;
+    while (process(tctx) == 0)
+        tctx->stats.n_chunks++;
+
+    tctx->stats.wall_us = now_us() - start_us;
+
+    /* Busy is whatever was not spent stalled */
+    int64_t busy_us = tctx->stats.wall_us;
+    for (int i = 0; i < WHISPER_STREAM_TIME_COUNT; i++)
+        if (i != WHISPER_STREAM_TIME_BUSY)
+            busy_us -= tctx->stats.time_us[i];
+    tctx->stats.time_us[WHISPER_STREAM_TIME_BUSY] = busy_us > 0 ? busy_us : 0;
+}
+
+static void
+log_slot_time(struct thread_ctx *tctx)
+{
+    const struct whisper_stream_slot_stats *stats = &tctx->stats;
+    int64_t wall_us = stats->wall_us > 0 ? stats->wall_us : 1;
+    char line[256];
+    int len = 0;
+
+    for (int i = 0; i < WHISPER_STREAM_TIME_COUNT && len < (int)sizeof line; i++)
+        len += snprintf(line + len, sizeof line - len, "%s%s %.1f%%",
+                        i ? ", " : "", time_names[i],
+                        100.0 * stats->time_us[i] / wall_us);
+
+    TCTX_LOGI(tctx, "%d chunks in %.1fs, RTF %.2f: %s\n", stats->n_chunks,
+              stats->wall_us / 1e6, atomic_load(&tctx->rtf), line);
+}
+
 static void *
 worker_thread_func(void *arg)
 {
     struct thread_ctx *tctx = arg;
 
-    while (process_one_chunk(tctx) == 0)
-        ;
+    run_slot(tctx);
 
     return NULL;
 }
@@ -660,6 +943,16 @@ init_thread_ctx(struct thread_ctx *tctx, struct common_ctx *cctx,
     tctx->segment_cb = NULL;
     tctx->segment_cb_user_data = NULL;
 
+    atomic_init(&tctx->rtf, 0.0f);
+    tctx->cycle_start_us = 0;
+
+    memset(&tctx->stats, 0, sizeof tctx->stats);
+    mem_set(&tctx->stats.mem, WHISPER_STREAM_MEM_AUDIO,
+            cctx->buffer_size * sizeof *tctx->buffer);
+    mem_set(&tctx->stats.mem, WHISPER_STREAM_MEM_TOKENS,
+            cctx->max_ctx_tokens * sizeof *tctx->tokens);
+    update_slot_mem(tctx);
+
     return 0;
 }
 
@@ -708,15 +1001,26 @@ init_common_ctx(struct common_ctx *cctx,
     }
     cctx->read_buffer_len = 0;
 
+    memset(&cctx->mem, 0, sizeof cctx->mem);
+    mem_set(&cctx->mem, WHISPER_STREAM_MEM_AUDIO,
+            cctx->buffer_size * sizeof *cctx->read_buffer);
+    cctx->stats_out = sparams->stats;
+
     cctx->progress_cb = sparams->progress_callback;
     cctx->progress_cb_user_data = sparams->progress_callback_user_data;
 
+    cctx->duration_cb = sparams->duration_callback;
+    cctx->duration_cb_user_data = sparams->duration_callback_user_data;
+
     cctx->language_cb = sparams->language_callback;
     cctx->language_cb_user_data = sparams->language_callback_user_data;
 
     cctx->abort_cb = sparams->abort_callback;
     cctx->abort_cb_user_data = sparams->abort_callback_user_data;
 
+    cctx->chunk_cb = sparams->chunk_callback;
+    cctx->chunk_cb_user_data = sparams->chunk_callback_user_data;
+
     return 0;
 }
 
@@ -749,13 +1053,53 @@ whisper_stream_default_params(void)
     params.segment_callback_user_data = NULL;
     params.progress_callback = NULL;
     params.progress_callback_user_data = NULL;
+    params.duration_callback = NULL;
+    params.duration_callback_user_data = NULL;
     params.language_callback = NULL;
     params.language_callback_user_data = NULL;
     params.abort_callback = NULL;
     params.abort_callback_user_data = NULL;
+    params.chunk_callback = NULL;
+    params.chunk_callback_user_data = NULL;
+    params.stats = NULL;
     return params;
 }
 
+const char *
+whisper_stream_mem_name(enum whisper_stream_mem mem)
+{
+    if ((unsigned)mem >= WHISPER_STREAM_MEM_COUNT)
+        return "unknown";
+    return mem_names[mem];
+}
+
+const char *
+whisper_stream_time_name(enum whisper_stream_time time)
+{
+    if ((unsigned)time >= WHISPER_STREAM_TIME_COUNT)
+        return "unknown";
+    return time_names[time];
+}
+
+static void
+collect_stats(struct common_ctx *cctx, struct thread_ctx *tctx0,
+              struct thread_ctx *tctx1)
+{
+    struct whisper_stream_stats *stats = cctx->stats_out;
+    if (!stats)
+        return;
+
+    memset(stats, 0, sizeof *stats);
+    stats->mem = cctx->mem;
+    stats->slots[0] = tctx0->stats;
+    stats->slots[0].rtf = atomic_load(&tctx0->rtf);
+    if (tctx1)
+    {
+        stats->slots[1] = tctx1->stats;
+        stats->slots[1].rtf = atomic_load(&tctx1->rtf);
+    }
+}
+
 int
 whisper_stream_full(struct whisper_full_params params,
                     struct whisper_stream_params stream_params)
@@ -811,14 +1155,19 @@ whisper_stream_full(struct whisper_full_params params,
         pthread_create(&worker_thread, NULL, worker_thread_func, &tctx1);
     }
 
-    while (process_one_chunk(&tctx0) == 0)
-        ;
+    run_slot(&tctx0);
 
     if (dual)
-    {
         pthread_join(worker_thread, NULL);
+
+    log_slot_time(&tctx0);
+    if (dual)
+        log_slot_time(&tctx1);
+
+    collect_stats(&cctx, &tctx0, dual ? &tctx1 : NULL);
+
+    if (dual)
         cleanup_thread_ctx(&tctx1);
-    }
     cleanup_thread_ctx(&tctx0);
     int ret = atomic_load(&cctx.abort) ? -1 : 0;
     cleanup_common_ctx(&cctx);
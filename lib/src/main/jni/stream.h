@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-3.0-or-later */
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <whisper.h>
 
 /* Stream read callback - returns samples read (>0), 0 for EOF, negative for error */
@@ -8,17 +9,39 @@ typedef int (*whisper_stream_read_callback)(float *samples,
                                             int n_samples_max,
                                             void *user_data);
 
-/* Segment callback - timestamps in centiseconds, adjusted for chunk offset */
+struct whisper_stream_segment
+{
+    int64_t t0;                 /* centiseconds, adjusted for chunk offset */
+    int64_t t1;
+    const char *text;
+    int lang_id;                /* detected or forced language of the chunk */
+    int slot;
+    int chunk_idx;
+    int64_t latency_us;         /* since the chunk audio was cut from the stream */
+};
+
+/* Segment callback - called by the slot thread transcribing the chunk */
 typedef void (*whisper_stream_segment_callback)(struct whisper_context *ctx,
-                                                int64_t t0, int64_t t1,
-                                                const char *text,
+                                                const struct whisper_stream_segment *segment,
                                                 void *user_data);
 
-/* Progress callback - chunk_progress is 0-100 within current chunk */
-typedef void (*whisper_stream_progress_callback)(int chunk_progress,
-                                                 int64_t samples_before,
-                                                 int chunk_samples,
-                                                 void *user_data);
+struct whisper_stream_progress
+{
+    int chunk_progress;         /* 0-100 within current chunk */
+    int64_t samples_before;     /* samples before the current chunk */
+    int chunk_samples;
+    int64_t samples_done;       /* samples_before + chunk_progress share of chunk */
+    int64_t samples_total;      /* from the duration callback, 0 if unknown */
+    float speed;                /* smoothed audio seconds per second, all slots */
+    int64_t eta_ms;             /* -1 if duration or speed is unknown */
+};
+
+/* Progress callback - reported by the slot processing the earliest chunk */
+typedef void (*whisper_stream_progress_callback)(
+    const struct whisper_stream_progress *progress, void *user_data);
+
+/* Duration callback - returns total input samples, 0 if unknown */
+typedef int64_t (*whisper_stream_duration_callback)(void *user_data);
 
 /* Language callback - returns lang_id to use (0 for auto-detect/no override) */
 typedef int (*whisper_stream_language_callback)(void *user_data);
@@ -26,6 +49,87 @@ typedef int (*whisper_stream_language_callback)(void *user_data);
 /* Abort callback - returns true to request abort */
 typedef bool (*whisper_stream_abort_callback)(void *user_data);
 
+/* Memory classes tracked by whisper_stream_mem_stats. Weights, KV, compute
+ * and VAD need the whisper.cpp getters of WHISPER_MEM_USAGE, 0 otherwise. */
+enum whisper_stream_mem
+{
+    WHISPER_STREAM_MEM_WEIGHTS,     /* model tensors */
+    WHISPER_STREAM_MEM_KV,          /* self, cross and pad KV caches */
+    WHISPER_STREAM_MEM_COMPUTE,     /* ggml compute buffers */
+    WHISPER_STREAM_MEM_AUDIO,       /* read and chunk sample buffers */
+    WHISPER_STREAM_MEM_TOKENS,      /* context token buffers */
+    WHISPER_STREAM_MEM_VAD,         /* VAD model, state and probabilities */
+    WHISPER_STREAM_MEM_COUNT
+};
+
+/* Bytes allocated per class: cur at end of stream, max is the largest value
+ * seen. Audio and token buffers are recorded when they are allocated, whisper
+ * and VAD buffers are sampled after each chunk, so max misses allocations that
+ * are freed within a chunk: it is a sampled maximum, not a high-water mark. */
+struct whisper_stream_mem_stats
+{
+    size_t cur[WHISPER_STREAM_MEM_COUNT];
+    size_t max[WHISPER_STREAM_MEM_COUNT];
+};
+
+/* Slot time classes, all but BUSY are stalls */
+enum whisper_stream_time
+{
+    WHISPER_STREAM_TIME_BUSY,       /* VAD and whisper_full(), minus stalls */
+    WHISPER_STREAM_TIME_TURN,       /* waiting for the other slot to take its chunk */
+    WHISPER_STREAM_TIME_CONTEXT,    /* waiting for the previous chunk context */
+    WHISPER_STREAM_TIME_READ,       /* waiting for audio from read_callback */
+    WHISPER_STREAM_TIME_COUNT
+};
+
+struct whisper_stream_slot_stats
+{
+    struct whisper_stream_mem_stats mem;
+
+    int n_chunks;
+    float rtf;                  /* smoothed processing time / audio time */
+    int64_t wall_us;
+    int64_t time_us[WHISPER_STREAM_TIME_COUNT];
+};
+
+/* Where a chunk was cut */
+enum whisper_stream_cut
+{
+    WHISPER_STREAM_CUT_SILENCE,     /* in a VAD gap of at least min_silence_ms */
+    WHISPER_STREAM_CUT_FORCED,      /* no silence found, cut at the maximum length */
+    WHISPER_STREAM_CUT_END,         /* rest of the stream */
+};
+
+/* Per chunk report, see whisper_stream_chunk_callback */
+struct whisper_stream_chunk_stats
+{
+    int slot;
+    int chunk_idx;
+    int samples;                /* new samples, overlap excluded */
+    int queued_samples;         /* samples left in the read buffer after handoff */
+    int result;                 /* whisper_full() result */
+    enum whisper_stream_cut cut;
+
+    /* Stalls of this chunk, BUSY is the rest of the chunk time */
+    int64_t time_us[WHISPER_STREAM_TIME_COUNT];
+    int64_t vad_us;             /* chunk boundary detection */
+    int64_t transcribe_us;      /* whisper_full(), context stall included */
+
+    struct whisper_stream_mem_stats mem;    /* slot memory after the chunk */
+};
+
+/* Chunk callback - called by the slot thread once its chunk is transcribed,
+ * concurrently from both slots in dual mode */
+typedef void (*whisper_stream_chunk_callback)(
+    const struct whisper_stream_chunk_stats *chunk, void *user_data);
+
+struct whisper_stream_stats
+{
+    struct whisper_stream_slot_stats slots[2];
+    /* Memory shared by all slots (read buffer) */
+    struct whisper_stream_mem_stats mem;
+};
+
 struct whisper_stream_slot
 {
     struct whisper_context *ctx;
@@ -54,16 +158,33 @@ struct whisper_stream_params
     whisper_stream_progress_callback progress_callback;
     void *progress_callback_user_data;
 
+    whisper_stream_duration_callback duration_callback;
+    void *duration_callback_user_data;
+
     whisper_stream_language_callback language_callback;
     void *language_callback_user_data;
 
     whisper_stream_abort_callback abort_callback;
     void *abort_callback_user_data;
+
+    whisper_stream_chunk_callback chunk_callback;
+    void *chunk_callback_user_data;
+
+    /* Optional, filled when whisper_stream_full() returns */
+    struct whisper_stream_stats *stats;
 };
 
 struct whisper_stream_params
 whisper_stream_default_params(void);
 
+/* Short name of a memory class, e.g. "weights" */
+const char *
+whisper_stream_mem_name(enum whisper_stream_mem mem);
+
+/* Short name of a time class, e.g. "context" */
+const char *
+whisper_stream_time_name(enum whisper_stream_time time);
+
 /* Process audio in chunks, splitting at silence boundaries.
  * stream_params.ctx1 enables parallel processing (NULL for single context).
  * Returns 0 on success, negative on error. */
@@ -0,0 +1,661 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+#include "audio.h"
+#include "bench_results.h"
+#include "stream.h"
+
+#include <dirent.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Relative to lib/src/main/jni, where the Makefile lives */
+#define DEFAULT_MODELS_DIR "../../../../models_pack/src/main/assets/models"
+#define DEFAULT_CORPUS     "../../../../app/src/androidTest/assets/test_long_273s.opus"
+#define DEFAULT_VAD_MODEL  "ggml-silero-v6.2.0.bin"
+
+/* Same modes as WhisperBenchmark, plus two CPU slots */
+enum bench_mode
+{
+    MODE_CPU,       /* one CPU slot */
+    MODE_DUAL,      /* two CPU slots, threads split */
+    MODE_GPU,       /* one GPU slot */
+    MODE_TURBO,     /* GPU slot and CPU slot */
+    MODE_COUNT
+};
+
+static const char *const mode_names[MODE_COUNT] = {
+    "CPU", "DUAL", "GPU", "TURBO",
+};
+
+struct bench_slot
+{
+    bool used;
+    bool gpu;
+    int threads;
+};
+
+struct bench_run
+{
+    double load_ms;
+    double transcribe_ms;
+    size_t mem_peak;
+};
+
+struct bench_stat
+{
+    double mean;
+    double ci;      /* 95% confidence half-width, 0 for a single run */
+};
+
+/* One configuration of a --sweep */
+struct sweep_point
+{
+    char label[16];
+    int threads;
+    double throughput;      /* audio time per transcription time */
+};
+
+static int64_t
+now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+log_disable(enum ggml_log_level level, const char *text, void *user_data)
+{
+    (void)level;
+    (void)text;
+    (void)user_data;
+}
+
+/* Mirrors the thread counts of WhisperTestUtils */
+static int
+mode_slots(enum bench_mode mode, int n_threads, struct bench_slot slots[2])
+{
+    memset(slots, 0, 2 * sizeof *slots);
+    slots[0].used = true;
+
+    switch (mode)
+    {
+    case MODE_CPU:
+        slots[0].threads = n_threads;
+        break;
+    case MODE_DUAL:
+        slots[0].threads = n_threads > 1 ? n_threads / 2 : 1;
+        slots[1].used = true;
+        slots[1].threads = n_threads > 1 ? n_threads - slots[0].threads : 1;
+        break;
+    case MODE_GPU:
+        slots[0].gpu = true;
+        slots[0].threads = 1;
+        break;
+    case MODE_TURBO:
+        slots[0].gpu = true;
+        slots[0].threads = 1;
+        slots[1].used = true;
+        slots[1].threads = n_threads > 1 ? n_threads - 1 : 1;
+        if (slots[1].threads > 8)
+            slots[1].threads = 8;
+        break;
+    default:
+        return -1;
+    }
+    return slots[0].threads + slots[1].threads;
+}
+
+/* Every thread split of a mode up to max_threads in total, returns the count */
+static int
+sweep_slots(enum bench_mode mode, int max_threads, struct bench_slot (*out)[2], int max_out)
+{
+    int n = 0;
+    struct bench_slot base[2];
+    mode_slots(mode, 1, base);
+
+    for (int a = 1; a <= max_threads; a++)
+    {
+        if (!base[1].used)
+        {
+            if (n == max_out)
+                return n;
+            memcpy(out[n], base, sizeof base);
+            out[n][0].threads = a;
+            n++;
+            continue;
+        }
+        for (int b = 1; a + b <= max_threads; b++)
+        {
+            /* Both CPU slots are alike, skip mirrored splits */
+            if (mode == MODE_DUAL && b < a)
+                continue;
+            if (n == max_out)
+                return n;
+            memcpy(out[n], base, sizeof base);
+            out[n][0].threads = a;
+            out[n][1].threads = b;
+            n++;
+        }
+    }
+    return n;
+}
+
+static int
+run_once(const char *model_path, const char *vad_path, const struct bench_slot slots[2],
+         const float *samples, int n_samples, struct bench_run *run)
+{
+    struct whisper_context *ctx[2] = { NULL, NULL };
+    struct whisper_vad_context *vad[2] = { NULL, NULL };
+    int ret = -1;
+
+    int64_t t_start = now_us();
+    for (int i = 0; i < 2; i++)
+    {
+        if (!slots[i].used)
+            continue;
+
+        struct whisper_context_params cparams = whisper_context_default_params();
+        cparams.flash_attn = cparams.use_gpu = slots[i].gpu;
+        ctx[i] = whisper_init_from_file_with_params(model_path, cparams);
+        if (!ctx[i])
+        {
+            fprintf(stderr, "Failed to load model: %s\n", model_path);
+            goto cleanup;
+        }
+
+        struct whisper_vad_context_params vp = whisper_vad_default_context_params();
+        vp.n_threads = 1;
+        vp.use_gpu = false;
+        vad[i] = whisper_vad_init_from_file_with_params(vad_path, vp);
+        if (!vad[i])
+        {
+            fprintf(stderr, "Failed to load VAD model: %s\n", vad_path);
+            goto cleanup;
+        }
+    }
+    int64_t t_loaded = now_us();
+
+    struct file_ctx fctx = { samples, n_samples, 0 };
+    struct whisper_stream_stats stats = {0};
+
+    struct whisper_full_params wparams = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    wparams.language = "en";
+    wparams.suppress_nst = true;
+
+    struct whisper_stream_params sparams = whisper_stream_default_params();
+    sparams.read_callback = file_read_cb;
+    sparams.read_callback_user_data = &fctx;
+    sparams.stats = &stats;
+    for (int i = 0; i < 2; i++)
+    {
+        sparams.slots[i].ctx = ctx[i];
+        sparams.slots[i].vad_ctx = vad[i];
+        sparams.slots[i].num_threads = slots[i].threads;
+    }
+
+    ret = whisper_stream_full(wparams, sparams);
+    int64_t t_done = now_us();
+
+    run->load_ms = (t_loaded - t_start) / 1000.0;
+    run->transcribe_ms = (t_done - t_loaded) / 1000.0;
+
+    run->mem_peak = 0;
+    for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+    {
+        run->mem_peak += stats.slots[0].mem.max[c] + stats.slots[1].mem.max[c]
+                       + stats.mem.max[c];
+    }
+
+cleanup:
+    for (int i = 0; i < 2; i++)
+    {
+        if (vad[i])
+            whisper_vad_free(vad[i]);
+        if (ctx[i])
+            whisper_free(ctx[i]);
+    }
+    return ret;
+}
+
+/* Two-sided 95% Student t critical values, df 1..30 */
+static const double t95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+static struct bench_stat
+compute_stat(const double *values, int n)
+{
+    struct bench_stat st = { 0, 0 };
+    if (n <= 0)
+        return st;
+
+    for (int i = 0; i < n; i++)
+        st.mean += values[i];
+    st.mean /= n;
+
+    if (n < 2)
+        return st;
+
+    double var = 0;
+    for (int i = 0; i < n; i++)
+        var += (values[i] - st.mean) * (values[i] - st.mean);
+    var /= n - 1;
+
+    int df = n - 1;
+    double t = df <= (int)(sizeof t95 / sizeof t95[0]) ? t95[df - 1] : 1.960;
+    st.ci = t * sqrt(var / n);
+    return st;
+}
+
+/* "ggml-small-q8_0.bin" -> "small", like WhisperBenchmark */
+static void
+model_display_name(const char *path, char *out, size_t size)
+{
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    if (strncmp(base, "ggml-", 5) == 0)
+        base += 5;
+
+    size_t len = strcspn(base, ".");
+    const char *q = strstr(base, "-q");
+    if (q && (size_t)(q - base) < len)
+        len = q - base;
+    snprintf(out, size, "%.*s", (int)len, base);
+}
+
+/* A name like "small" picks ggml-small*.bin from the models directory,
+ * a file name ending in .bin is taken from it, a path is used as is */
+static char *
+resolve_model(const char *dir, const char *name)
+{
+    size_t len = strlen(name);
+    if (strchr(name, '/') || (len > 4 && strcmp(name + len - 4, ".bin") == 0))
+    {
+        if (!strchr(name, '/'))
+        {
+            char *path = malloc(strlen(dir) + len + 2);
+            if (path)
+                sprintf(path, "%s/%s", dir, name);
+            return path;
+        }
+        return strdup(name);
+    }
+
+    DIR *d = opendir(dir);
+    if (!d)
+    {
+        fprintf(stderr, "Failed to open models directory: %s\n", dir);
+        return NULL;
+    }
+
+    char prefix[256];
+    snprintf(prefix, sizeof prefix, "ggml-%s", name);
+    size_t plen = strlen(prefix);
+
+    char *path = NULL;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL)
+    {
+        const char *n = e->d_name;
+        if (strncmp(n, prefix, plen) != 0 || (n[plen] != '-' && n[plen] != '.'))
+            continue;
+        path = malloc(strlen(dir) + strlen(n) + 2);
+        if (path)
+            sprintf(path, "%s/%s", dir, n);
+        break;
+    }
+    closedir(d);
+
+    if (!path)
+        fprintf(stderr, "No model '%s' in %s\n", name, dir);
+    return path;
+}
+
+static int
+parse_modes(const char *list, bool modes[MODE_COUNT])
+{
+    memset(modes, 0, MODE_COUNT * sizeof *modes);
+
+    while (*list)
+    {
+        size_t len = strcspn(list, ",");
+        int m;
+        for (m = 0; m < MODE_COUNT; m++)
+        {
+            if (strlen(mode_names[m]) == len && strncasecmp(list, mode_names[m], len) == 0)
+                break;
+        }
+        if (m == MODE_COUNT)
+        {
+            fprintf(stderr, "Unknown mode: %.*s\n", (int)len, list);
+            return -1;
+        }
+        modes[m] = true;
+        list += len;
+        if (*list == ',')
+            list++;
+    }
+    return 0;
+}
+
+/* Pareto front over threads and throughput: no other point is at least as
+ * fast with at most as many threads */
+static void
+print_pareto(const char *model_name, const struct bench_host *host,
+             const struct sweep_point *points, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        bool dominated = false;
+        for (int j = 0; j < n && !dominated; j++)
+        {
+            if (j == i)
+                continue;
+            const struct sweep_point *p = &points[i], *q = &points[j];
+            dominated = q->threads <= p->threads && q->throughput >= p->throughput
+                        && (q->threads < p->threads || q->throughput > p->throughput
+                            || j < i);
+        }
+        if (!dominated)
+            printf("PARETO: %s | %s | %d threads | %s | throughput=%.2fx\n", host->cpu,
+                   model_name, points[i].threads, points[i].label, points[i].throughput);
+    }
+    fflush(stdout);
+}
+
+static void
+slots_label(enum bench_mode mode, const struct bench_slot slots[2], bool split,
+            char *out, size_t size)
+{
+    if (!split)
+        snprintf(out, size, "%s", mode_names[mode]);
+    else if (slots[1].used)
+        snprintf(out, size, "%s %d+%d", mode_names[mode], slots[0].threads, slots[1].threads);
+    else
+        snprintf(out, size, "%s %d", mode_names[mode], slots[0].threads);
+}
+
+static int
+bench_mode(const char *model_path, const char *vad_path, const char *model_name,
+           const char *label, const struct bench_slot slots[2], int warmup, int reps,
+           const float *samples, int n_samples, struct bench_result *result)
+{
+    int total_threads = slots[0].threads + (slots[1].used ? slots[1].threads : 0);
+    int64_t duration_ms = (int64_t)n_samples * 1000 / WHISPER_SAMPLE_RATE;
+
+    double *load = calloc(reps, sizeof *load);
+    double *transcribe = calloc(reps, sizeof *transcribe);
+    double *rtf = calloc(reps, sizeof *rtf);
+    size_t mem_peak = 0;
+    int ret = -1;
+
+    if (!load || !transcribe || !rtf)
+        goto cleanup;
+
+    for (int i = 0; i < warmup + reps; i++)
+    {
+        struct bench_run run;
+        bool is_warmup = i < warmup;
+
+        if (run_once(model_path, vad_path, slots, samples, n_samples, &run) != 0)
+        {
+            fprintf(stderr, "%s: run %d failed\n", label, i);
+            goto cleanup;
+        }
+        fprintf(stderr, "%s %s %d: load=%.0fms transcribe=%.0fms\n",
+                label, is_warmup ? "warm-up" : "run",
+                is_warmup ? i : i - warmup, run.load_ms, run.transcribe_ms);
+
+        if (is_warmup)
+            continue;
+        load[i - warmup] = run.load_ms;
+        transcribe[i - warmup] = run.transcribe_ms;
+        rtf[i - warmup] = duration_ms > 0 ? run.transcribe_ms / duration_ms : 0;
+        if (run.mem_peak > mem_peak)
+            mem_peak = run.mem_peak;
+    }
+
+    struct bench_stat load_st = compute_stat(load, reps);
+    struct bench_stat transcribe_st = compute_stat(transcribe, reps);
+    struct bench_stat rtf_st = compute_stat(rtf, reps);
+
+    printf("BENCHMARK: %s | %lldms | %d threads | %s | load=%.0fms | transcribe=%.0fms | RTF=%.2fx"
+           " | n=%d | ci95: load=±%.0fms transcribe=±%.0fms RTF=±%.2fx\n",
+           model_name, (long long)duration_ms, total_threads, label,
+           load_st.mean, transcribe_st.mean, rtf_st.mean,
+           reps, load_st.ci, transcribe_st.ci, rtf_st.ci);
+    fflush(stdout);
+
+    memset(result, 0, sizeof *result);
+    snprintf(result->model, sizeof result->model, "%s", model_name);
+    snprintf(result->mode, sizeof result->mode, "%s", label);
+    result->threads = total_threads;
+    result->audio_ms = duration_ms;
+    result->n = reps;
+    result->load_ms = load_st.mean;
+    result->load_ci = load_st.ci;
+    result->transcribe_ms = transcribe_st.mean;
+    result->transcribe_ci = transcribe_st.ci;
+    result->rtf = rtf_st.mean;
+    result->rtf_ci = rtf_st.ci;
+    result->mem_peak = mem_peak;
+    ret = 0;
+
+cleanup:
+    free(load);
+    free(transcribe);
+    free(rtf);
+    return ret;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options] [audio files...]\n", prog);
+    fprintf(stderr, "  -d, --models DIR      Models directory (default: %s)\n", DEFAULT_MODELS_DIR);
+    fprintf(stderr, "  -m, --model NAME      Model name or path (default: small)\n");
+    fprintf(stderr, "  -v, --vad-model NAME  VAD model (default: %s)\n", DEFAULT_VAD_MODEL);
+    fprintf(stderr, "  -M, --modes LIST      cpu,dual,gpu,turbo (default: cpu,dual)\n");
+    fprintf(stderr, "  -t, --threads N       CPU threads (default: all cores)\n");
+    fprintf(stderr, "  -w, --warmup N        Warm-up runs per mode (default: 1)\n");
+    fprintf(stderr, "  -r, --reps N          Measured runs per mode (default: 3)\n");
+    fprintf(stderr, "  -s, --sweep           Run every thread split up to --threads and print\n"
+                    "                        the Pareto front of threads against throughput\n");
+    fprintf(stderr, "      --json FILE       Save results as JSON\n");
+    fprintf(stderr, "      --baseline FILE   Compare with results saved by --json, exit 2 on regressions\n");
+    fprintf(stderr, "      --threshold F     Relative change below which nothing is flagged (default: 0.05)\n");
+    fprintf(stderr, "      --commit ID       Commit recorded in the results (default: git HEAD)\n");
+    fprintf(stderr, "Audio defaults to %s\n", DEFAULT_CORPUS);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *models_dir = DEFAULT_MODELS_DIR;
+    const char *model = "small";
+    const char *vad_model = DEFAULT_VAD_MODEL;
+    const char *mode_list = "cpu,dual";
+    int n_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int warmup = 1;
+    int reps = 3;
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    const char *commit = NULL;
+    double threshold = 0.05;
+    bool sweep = false;
+
+    enum { OPT_JSON = 256, OPT_BASELINE, OPT_THRESHOLD, OPT_COMMIT };
+    static struct option long_opts[] = {
+        {"models",    required_argument, 0, 'd'},
+        {"model",     required_argument, 0, 'm'},
+        {"vad-model", required_argument, 0, 'v'},
+        {"modes",     required_argument, 0, 'M'},
+        {"threads",   required_argument, 0, 't'},
+        {"warmup",    required_argument, 0, 'w'},
+        {"reps",      required_argument, 0, 'r'},
+        {"sweep",     no_argument,       0, 's'},
+        {"json",      required_argument, 0, OPT_JSON},
+        {"baseline",  required_argument, 0, OPT_BASELINE},
+        {"threshold", required_argument, 0, OPT_THRESHOLD},
+        {"commit",    required_argument, 0, OPT_COMMIT},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:m:v:M:t:w:r:s", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'd': models_dir = optarg; break;
+        case 'm': model = optarg; break;
+        case 'v': vad_model = optarg; break;
+        case 'M': mode_list = optarg; break;
+        case 't': n_threads = atoi(optarg); break;
+        case 'w': warmup = atoi(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case 's': sweep = true; break;
+        case OPT_JSON: json_path = optarg; break;
+        case OPT_BASELINE: baseline_path = optarg; break;
+        case OPT_THRESHOLD: threshold = atof(optarg); break;
+        case OPT_COMMIT: commit = optarg; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bool modes[MODE_COUNT];
+    if (parse_modes(mode_list, modes) < 0)
+        return 1;
+
+    if (n_threads < 1)
+        n_threads = 1;
+    if (warmup < 0 || reps < 1)
+    {
+        fprintf(stderr, "warmup must be >= 0 and reps >= 1\n");
+        return 1;
+    }
+
+    whisper_log_set(log_disable, NULL);
+
+    int ret = 1;
+    struct bench_result *results = NULL;
+    int n_results = 0;
+    struct bench_slot (*configs)[2] = NULL;
+    struct sweep_point *points = NULL;
+    char *model_path = resolve_model(models_dir, model);
+    char *vad_path = resolve_model(models_dir, vad_model);
+    if (!model_path || !vad_path)
+        goto cleanup;
+
+    char model_name[64];
+    model_display_name(model_path, model_name, sizeof model_name);
+
+    struct bench_host host;
+    bench_host_detect(&host, commit);
+
+    const char *default_corpus[] = { DEFAULT_CORPUS };
+    const char **files = (const char **)argv + optind;
+    int n_files = argc - optind;
+    if (n_files == 0)
+    {
+        files = default_corpus;
+        n_files = 1;
+    }
+
+    /* Single slot modes have n_threads splits, two slot modes fewer than n^2/2 */
+    int max_configs = sweep ? n_threads * n_threads / 2 + n_threads : 1;
+    results = calloc((size_t)n_files * MODE_COUNT * max_configs, sizeof *results);
+    configs = calloc(max_configs, sizeof *configs);
+    points = calloc((size_t)MODE_COUNT * max_configs, sizeof *points);
+    if (!results || !configs || !points)
+        goto cleanup;
+
+    ret = 0;
+    for (int f = 0; f < n_files; f++)
+    {
+        int n_samples;
+        float *samples = read_avcodec(files[f], &n_samples);
+        if (!samples)
+        {
+            ret = 1;
+            continue;
+        }
+        fprintf(stderr, "%s: %.1fs\n", files[f], (float)n_samples / WHISPER_SAMPLE_RATE);
+
+        int n_points = 0;
+        for (int m = 0; m < MODE_COUNT; m++)
+        {
+            if (!modes[m])
+                continue;
+
+            int n_configs = 1;
+            if (sweep)
+                n_configs = sweep_slots(m, n_threads, configs, max_configs);
+            else
+                mode_slots(m, n_threads, configs[0]);
+
+            for (int c = 0; c < n_configs; c++)
+            {
+                struct bench_result *r = &results[n_results];
+                char label[16];
+                slots_label(m, configs[c], sweep, label, sizeof label);
+                if (bench_mode(model_path, vad_path, model_name, label, configs[c],
+                               warmup, reps, samples, n_samples, r) < 0)
+                {
+                    ret = 1;
+                    continue;
+                }
+                n_results++;
+
+                struct sweep_point *p = &points[n_points++];
+                snprintf(p->label, sizeof p->label, "%s", label);
+                p->threads = r->threads;
+                p->throughput = r->rtf > 0 ? 1.0 / r->rtf : 0;
+            }
+        }
+        if (sweep)
+            print_pareto(model_name, &host, points, n_points);
+        free(samples);
+    }
+
+    if (json_path && bench_results_save(json_path, &host, results, n_results) < 0)
+        ret = 1;
+
+    if (baseline_path)
+    {
+        struct bench_host base_host;
+        struct bench_result *base;
+        int n_base;
+        if (bench_results_load(baseline_path, &base_host, &base, &n_base) < 0)
+        {
+            ret = 1;
+        }
+        else
+        {
+            if (bench_results_compare(&base_host, base, n_base, &host,
+                                      results, n_results, threshold) > 0 && ret == 0)
+                ret = 2;
+            free(base);
+        }
+    }
+
+cleanup:
+    free(points);
+    free(configs);
+    free(results);
+    free(model_path);
+    free(vad_path);
+    return ret;
+}
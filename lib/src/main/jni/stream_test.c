@@ -1,13 +1,11 @@
 /* SPDX-License-Identifier: GPL-3.0-or-later */
 
+#include "audio.h"
+#include "metrics.h"
 #include "stream.h"
 
-#include <libavcodec/avcodec.h>
-#include <libavformat/avformat.h>
-#include <libavutil/opt.h>
-#include <libswresample/swresample.h>
-
 #include <getopt.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -15,6 +13,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 static atomic_bool *g_abort_ptr = NULL;
 
@@ -33,234 +32,290 @@ abort_cb(void *user_data)
     return atomic_load(abort);
 }
 
-struct decode_ctx
+static int64_t
+now_ms(void)
 {
-    AVFormatContext *fmt_ctx;
-    AVCodecContext *codec_ctx;
-    AVPacket *pkt;
-    AVFrame *frame;
-    SwrContext *swr_ctx;
-    float *samples;
-    int sample_count;
-    int sample_capacity;
-};
-
-static int
-ensure_capacity(struct decode_ctx *d, int needed)
-{
-    if (d->sample_count + needed <= d->sample_capacity)
-        return 0;
-
-    int new_cap = d->sample_capacity ? d->sample_capacity * 2 : 1024 * 1024;
-    while (new_cap < d->sample_count + needed)
-        new_cap *= 2;
-    float *tmp = realloc(d->samples, new_cap * sizeof(float));
-    if (!tmp)
-        return -1;
-    d->samples = tmp;
-    d->sample_capacity = new_cap;
-    return 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
-static int
-drain_frames(struct decode_ctx *d)
+static void
+print_json_string(const char *s)
 {
-    while (avcodec_receive_frame(d->codec_ctx, d->frame) >= 0)
+    putchar('"');
+    for (; *s; s++)
     {
-        int out_samples = swr_get_out_samples(d->swr_ctx, d->frame->nb_samples);
-        if (ensure_capacity(d, out_samples) < 0)
-        {
-            av_frame_unref(d->frame);
-            return -1;
-        }
-
-        uint8_t *out_buf = (uint8_t *)(d->samples + d->sample_count);
-        int converted = swr_convert(d->swr_ctx, &out_buf, out_samples,
-                                    (const uint8_t **)d->frame->extended_data,
-                                    d->frame->nb_samples);
-        if (converted > 0)
-            d->sample_count += converted;
-
-        av_frame_unref(d->frame);
+        unsigned char c = *s;
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c == '\n')
+            fputs("\\n", stdout);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
     }
-    return 0;
+    putchar('"');
 }
 
-static int
-flush_resampler(struct decode_ctx *d)
+static void
+segment_cb(struct whisper_context *ctx, const struct whisper_stream_segment *seg,
+           void *user_data)
 {
-    while (swr_get_delay(d->swr_ctx, WHISPER_SAMPLE_RATE) > 0)
+    (void)ctx;
+    bool jsonl = *(bool *)user_data;
+    int64_t ms0 = seg->t0 * 10;
+    int64_t ms1 = seg->t1 * 10;
+
+    if (jsonl)
     {
-        if (ensure_capacity(d, 1024) < 0)
-            return -1;
-        uint8_t *out_buf = (uint8_t *)(d->samples + d->sample_count);
-        int converted = swr_convert(d->swr_ctx, &out_buf, 1024, NULL, 0);
-        if (converted <= 0)
-            break;
-        d->sample_count += converted;
+        printf("{\"type\":\"segment\",\"t0_ms\":%lld,\"t1_ms\":%lld,\"text\":",
+               (long long)ms0, (long long)ms1);
+        print_json_string(seg->text);
+        printf(",\"language\":");
+        if (seg->lang_id >= 0)
+            print_json_string(whisper_lang_str(seg->lang_id));
+        else
+            printf("null");
+        printf(",\"slot\":%d,\"chunk\":%d,\"latency_ms\":%.1f}\n",
+               seg->slot, seg->chunk_idx, seg->latency_us / 1000.0);
     }
-    return 0;
+    else
+    {
+        printf("[%02d:%02d.%03d --> %02d:%02d.%03d]%s\n",
+               (int)(ms0 / 60000), (int)((ms0 % 60000) / 1000), (int)(ms0 % 1000),
+               (int)(ms1 / 60000), (int)((ms1 % 60000) / 1000), (int)(ms1 % 1000),
+               seg->text);
+    }
+    fflush(stdout);
 }
 
 static void
-decode_ctx_free(struct decode_ctx *d)
+print_json_summary(const struct whisper_stream_stats *stats, int n_slots,
+                   int n_samples, int64_t decode_ms, int64_t load_ms,
+                   int64_t transcribe_ms, int result)
 {
-    free(d->samples);
-    av_frame_free(&d->frame);
-    av_packet_free(&d->pkt);
-    swr_free(&d->swr_ctx);
-    avcodec_free_context(&d->codec_ctx);
-    avformat_close_input(&d->fmt_ctx);
-}
+    double audio_s = (double)n_samples / WHISPER_SAMPLE_RATE;
 
-static float *
-read_avcodec(const char *path, int *n_samples)
-{
-    struct decode_ctx d = {0};
+    printf("{\"type\":\"summary\",\"result\":%d,\"audio_s\":%.3f,"
+           "\"decode_ms\":%lld,\"load_ms\":%lld,\"transcribe_ms\":%lld,"
+           "\"rtf\":%.4f,\"slots\":[",
+           result, audio_s, (long long)decode_ms, (long long)load_ms,
+           (long long)transcribe_ms,
+           audio_s > 0 ? transcribe_ms / 1000.0 / audio_s : 0.0);
 
-    if (avformat_open_input(&d.fmt_ctx, path, NULL, NULL) < 0)
+    for (int i = 0; i < n_slots; i++)
     {
-        fprintf(stderr, "Failed to open: %s\n", path);
-        return NULL;
+        const struct whisper_stream_slot_stats *s = &stats->slots[i];
+        size_t max = 0;
+        for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+            max += s->mem.max[c];
+
+        printf("%s{\"slot\":%d,\"chunks\":%d,\"rtf\":%.4f,\"wall_ms\":%lld",
+               i ? "," : "", i, s->n_chunks, s->rtf, (long long)(s->wall_us / 1000));
+        for (int t = 0; t < WHISPER_STREAM_TIME_COUNT; t++)
+            printf(",\"%s_ms\":%lld", whisper_stream_time_name(t),
+                   (long long)(s->time_us[t] / 1000));
+        printf(",\"mem_max_bytes\":%zu}", max);
     }
+    printf("]}\n");
+    fflush(stdout);
+}
 
-    if (avformat_find_stream_info(d.fmt_ctx, NULL) < 0)
-    {
-        fprintf(stderr, "Failed to find stream info\n");
-        goto cleanup;
-    }
+static void
+log_disable(enum ggml_log_level level, const char *text, void *user_data)
+{
+    (void)level;
+    (void)text;
+    (void)user_data;
+}
 
-    int stream_idx = av_find_best_stream(d.fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, NULL, 0);
-    if (stream_idx < 0)
-    {
-        fprintf(stderr, "No audio stream found\n");
-        goto cleanup;
-    }
+/* Ops the scheduler places on a GPU backend and the bytes it copies between
+ * backends, from its GGML_SCHED_DEBUG assignment dump: "## SPLIT #n: backend
+ * # k inputs: [name (size)] ...", then at level 2 "node #i (OP): ..." */
+#define MAX_RECORDED_OPS 64
 
-    AVStream *stream = d.fmt_ctx->streams[stream_idx];
-    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
-    if (!codec)
+struct op_recorder
+{
+    char line[4096];
+    size_t len;
+    bool gpu_split;
+    bool debug;
+    char ops[MAX_RECORDED_OPS][32];
+    int n_ops;
+    /* Split inputs, copied to the split backend before it runs */
+    int64_t to_gpu_bytes;
+    int64_t to_cpu_bytes;
+};
+
+/* Sizes are printed as "%zuK" or "%zuM", rounded down */
+static int64_t
+split_input_bytes(const char *inputs)
+{
+    int64_t bytes = 0;
+    const char *p = inputs;
+    while ((p = strstr(p, " (")) != NULL)
     {
-        fprintf(stderr, "Unsupported codec\n");
-        goto cleanup;
+        char *end;
+        long long size = strtoll(p + 2, &end, 10);
+        if (*end == 'M')
+            bytes += size << 20;
+        else if (*end == 'K')
+            bytes += size << 10;
+        p = end;
     }
+    return bytes;
+}
 
-    d.codec_ctx = avcodec_alloc_context3(codec);
-    if (!d.codec_ctx)
-        goto cleanup;
-
-    if (avcodec_parameters_to_context(d.codec_ctx, stream->codecpar) < 0)
-        goto cleanup;
-
-    d.codec_ctx->thread_count = 1;
+static void
+record_op_line(struct op_recorder *rec)
+{
+    const char *line = rec->line;
+    while (*line == '\n')
+        line++;
 
-    if (avcodec_open2(d.codec_ctx, codec, NULL) < 0)
+    if (strncmp(line, "## SPLIT #", 10) == 0)
     {
-        fprintf(stderr, "Failed to open codec\n");
-        goto cleanup;
+        const char *backend = strstr(line, ": ");
+        rec->gpu_split = backend && strncmp(backend + 2, "CPU", 3) != 0;
+        const char *inputs = strstr(line, "inputs: ");
+        if (inputs)
+        {
+            int64_t bytes = split_input_bytes(inputs);
+            if (rec->gpu_split)
+                rec->to_gpu_bytes += bytes;
+            else
+                rec->to_cpu_bytes += bytes;
+        }
+        return;
     }
-
-    AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
-    if (swr_alloc_set_opts2(&d.swr_ctx,
-                            &out_layout, AV_SAMPLE_FMT_FLT, WHISPER_SAMPLE_RATE,
-                            &d.codec_ctx->ch_layout, d.codec_ctx->sample_fmt, d.codec_ctx->sample_rate,
-                            0, NULL) < 0)
-        goto cleanup;
-
-    if (swr_init(d.swr_ctx) < 0)
+    if (!rec->gpu_split || strncmp(line, "node #", 6) != 0)
+        return;
+
+    const char *open = strchr(line, '(');
+    const char *close = open ? strchr(open, ')') : NULL;
+    if (!close)
+        return;
+    while (*++open == ' ')
+        ;
+    int len = close - open;
+    if (len <= 0 || len >= (int)sizeof rec->ops[0])
+        return;
+
+    for (int i = 0; i < rec->n_ops; i++)
+        if ((int)strlen(rec->ops[i]) == len && strncmp(rec->ops[i], open, len) == 0)
+            return;
+    if (rec->n_ops < MAX_RECORDED_OPS)
     {
-        fprintf(stderr, "Failed to init resampler\n");
-        goto cleanup;
+        memcpy(rec->ops[rec->n_ops], open, len);
+        rec->ops[rec->n_ops++][len] = '\0';
     }
+}
 
-    d.pkt = av_packet_alloc();
-    d.frame = av_frame_alloc();
-    if (!d.pkt || !d.frame)
-        goto cleanup;
+/* ggml logs the dump in pieces, lines are put back together first. Both
+ * stream contexts log, from their slot threads. */
+static void
+record_ops_log(enum ggml_log_level level, const char *text, void *user_data)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    struct op_recorder *rec = user_data;
+    if (rec->debug || level >= GGML_LOG_LEVEL_WARN)
+        fputs(text, stderr);
 
-    while (av_read_frame(d.fmt_ctx, d.pkt) >= 0)
+    pthread_mutex_lock(&lock);
+    for (; *text; text++)
     {
-        if (d.pkt->stream_index != stream_idx)
+        if (*text == '\n')
         {
-            av_packet_unref(d.pkt);
-            continue;
+            rec->line[rec->len] = '\0';
+            record_op_line(rec);
+            rec->len = 0;
         }
-
-        if (avcodec_send_packet(d.codec_ctx, d.pkt) < 0)
+        else if (rec->len < sizeof rec->line - 1)
         {
-            av_packet_unref(d.pkt);
-            continue;
+            rec->line[rec->len++] = *text;
         }
-
-        if (drain_frames(&d) < 0)
-            goto cleanup;
-
-        av_packet_unref(d.pkt);
     }
-
-    /* Flush decoder */
-    avcodec_send_packet(d.codec_ctx, NULL);
-    if (drain_frames(&d) < 0)
-        goto cleanup;
-
-    if (flush_resampler(&d) < 0)
-        goto cleanup;
-
-    *n_samples = d.sample_count;
-
-    float *samples = d.samples;
-    d.samples = NULL;
-    decode_ctx_free(&d);
-    return samples;
-
-cleanup:
-    decode_ctx_free(&d);
-    *n_samples = 0;
-    return NULL;
+    pthread_mutex_unlock(&lock);
 }
 
-struct file_ctx
+static int
+compare_op(const void *a, const void *b)
 {
-    const float *samples;
-    int n_samples;
-    int pos;
-};
+    return strcmp(a, b);
+}
 
 static int
-file_read_cb(float *out, int n_max, void *user_data)
+write_ops(struct op_recorder *rec, const char *path)
 {
-    struct file_ctx *ctx = user_data;
-    int remaining = ctx->n_samples - ctx->pos;
-    int n = (n_max < remaining) ? n_max : remaining;
-    if (n > 0)
+    FILE *f = fopen(path, "w");
+    if (!f)
     {
-        memcpy(out, ctx->samples + ctx->pos, n * sizeof(float));
-        ctx->pos += n;
+        fprintf(stderr, "Failed to open %s\n", path);
+        return -1;
     }
-    return n;
+    qsort(rec->ops, rec->n_ops, sizeof rec->ops[0], compare_op);
+    fprintf(f, "# Ops on the GPU backend, recorded by stream_test --ops\n");
+    for (int i = 0; i < rec->n_ops; i++)
+        fprintf(f, "%s\n", rec->ops[i]);
+    fclose(f);
+    fprintf(stderr, "Recorded %d GPU ops in %s\n", rec->n_ops, path);
+    return 0;
 }
 
 static void
-segment_cb(struct whisper_context *ctx, int64_t t0, int64_t t1,
-           const char *text, void *user_data)
+print_transfers(const struct op_recorder *rec, const struct whisper_stream_stats *stats)
 {
-    (void)ctx;
-    (void)user_data;
-    int64_t ms0 = t0 * 10;
-    int64_t ms1 = t1 * 10;
-    printf("[%02d:%02d.%03d --> %02d:%02d.%03d]%s\n",
-           (int)(ms0 / 60000), (int)((ms0 % 60000) / 1000), (int)(ms0 % 1000),
-           (int)(ms1 / 60000), (int)((ms1 % 60000) / 1000), (int)(ms1 % 1000),
-           text);
-    fflush(stdout);
+    int n_chunks = stats->slots[0].n_chunks + stats->slots[1].n_chunks;
+    int64_t bytes = rec->to_gpu_bytes + rec->to_cpu_bytes;
+    fprintf(stderr, "Transfers (MiB): %.1f to GPU, %.1f to CPU, %.2f per chunk\n",
+            rec->to_gpu_bytes / 1048576.0, rec->to_cpu_bytes / 1048576.0,
+            n_chunks > 0 ? bytes / 1048576.0 / n_chunks : 0);
 }
 
 static void
-log_disable(enum ggml_log_level level, const char *text, void *user_data)
+print_mem_row(const char *name, const struct whisper_stream_mem_stats *mem,
+              int n_slots, int cls)
 {
-    (void)level;
-    (void)text;
-    (void)user_data;
+    fprintf(stderr, "  %-8s", name);
+    for (int i = 0; i <= n_slots; i++)
+    {
+        size_t cur = 0, max = 0;
+        if (cls < 0)
+        {
+            for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+            {
+                cur += mem[i].cur[c];
+                max += mem[i].max[c];
+            }
+        }
+        else
+        {
+            cur = mem[i].cur[cls];
+            max = mem[i].max[cls];
+        }
+        fprintf(stderr, " %8.1f/%-8.1f", cur / 1048576.0, max / 1048576.0);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void
+print_mem_stats(const struct whisper_stream_stats *stats, int n_slots)
+{
+    struct whisper_stream_mem_stats mem[3];
+    for (int i = 0; i < n_slots; i++)
+        mem[i] = stats->slots[i].mem;
+    mem[n_slots] = stats->mem;
+
+    fprintf(stderr, "Memory (MiB, cur/max sampled):\n  %-8s", "");
+    for (int i = 0; i < n_slots; i++)
+        fprintf(stderr, " ctx%d%13s", i, "");
+    fprintf(stderr, " shared\n");
+
+    for (int c = 0; c < WHISPER_STREAM_MEM_COUNT; c++)
+        print_mem_row(whisper_stream_mem_name(c), mem, n_slots, c);
+    print_mem_row("total", mem, n_slots, -1);
 }
 
 static void
@@ -276,6 +331,11 @@ usage(const char *prog)
     fprintf(stderr, "  -v, --vad-model PATH  VAD model\n");
     fprintf(stderr, "  -d, --debug           Enable debug output\n");
     fprintf(stderr, "  -L, --live            Live mode (5s min, 10s extend, 200ms silence)\n");
+    fprintf(stderr, "      --jsonl           One JSON record per segment, then a summary\n");
+    fprintf(stderr, "      --metrics TARGET  Prometheus metrics file, or unix:PATH socket\n");
+    fprintf(stderr, "      --metrics-interval MS  Metrics file rewrite interval (default: 5000)\n");
+    fprintf(stderr, "      --ops PATH        Record the ops run on the GPU backend\n");
+    fprintf(stderr, "      --transfers       Report the bytes copied between CPU and GPU\n");
 }
 
 static int
@@ -324,8 +384,13 @@ main(int argc, char **argv)
     int stream_ctx = 1;
     int n_threads = 4;
     bool use_gpu = true;
+    bool transfers = false;
     bool debug = false;
     bool live = false;
+    bool jsonl = false;
+    const char *metrics_target = NULL;
+    int metrics_interval = 5000;
+    const char *ops_path = NULL;
 
     static struct option long_opts[] = {
         {"model",     required_argument, 0, 'm'},
@@ -337,6 +402,11 @@ main(int argc, char **argv)
         {"vad-model", required_argument, 0, 'v'},
         {"debug",     no_argument,       0, 'd'},
         {"live",      no_argument,       0, 'L'},
+        {"jsonl",     no_argument,       0, 'J'},
+        {"metrics",   required_argument, 0, 'M'},
+        {"metrics-interval", required_argument, 0, 'I'},
+        {"ops",       required_argument, 0, 'O'},
+        {"transfers", no_argument,       0, 'T'},
         {0, 0, 0, 0}
     };
 
@@ -354,6 +424,11 @@ main(int argc, char **argv)
         case 'v': vad_model = optarg; break;
         case 'd': debug = true; break;
         case 'L': live = true; break;
+        case 'J': jsonl = true; break;
+        case 'M': metrics_target = optarg; break;
+        case 'I': metrics_interval = atoi(optarg); break;
+        case 'O': ops_path = optarg; break;
+        case 'T': transfers = true; break;
         default:
             usage(argv[0]);
             return 1;
@@ -372,7 +447,15 @@ main(int argc, char **argv)
         return 1;
     }
 
-    if (!debug)
+    static struct op_recorder op_rec;
+    if (ops_path || transfers)
+    {
+        /* Read when the contexts create their schedulers, nodes from level 2 */
+        setenv("GGML_SCHED_DEBUG", ops_path ? "2" : "1", 1);
+        op_rec.debug = debug;
+        whisper_log_set(record_ops_log, &op_rec);
+    }
+    else if (!debug)
         whisper_log_set(log_disable, NULL);
 
     int ret = 1;
@@ -381,8 +464,20 @@ main(int argc, char **argv)
     struct whisper_context *ctx1 = NULL;
     struct whisper_vad_context *vad_ctx = NULL;
     struct whisper_vad_context *vad_ctx1 = NULL;
+    struct metrics *metrics = NULL;
+
+    if (metrics_target)
+    {
+        metrics = metrics_create(metrics_target, metrics_interval);
+        if (!metrics)
+        {
+            fprintf(stderr, "Failed to set up metrics: %s\n", metrics_target);
+            return 1;
+        }
+    }
 
     int n_samples;
+    int64_t t_start = now_ms();
     samples = read_avcodec(file_path, &n_samples);
     if (!samples)
         goto cleanup;
@@ -390,6 +485,7 @@ main(int argc, char **argv)
     fprintf(stderr, "Loaded %d samples (%.1fs)\n",
             n_samples, (float)n_samples / WHISPER_SAMPLE_RATE);
 
+    int64_t t_decoded = now_ms();
     if (init_context(model_path, vad_model, use_gpu, &ctx0, &vad_ctx) < 0)
         goto cleanup;
 
@@ -398,6 +494,7 @@ main(int argc, char **argv)
         if (init_context(model_path, vad_model, false, &ctx1, &vad_ctx1) < 0)
             goto cleanup;
     }
+    int64_t t_loaded = now_ms();
 
     struct file_ctx fctx = { samples, n_samples, 0 };
 
@@ -413,7 +510,7 @@ main(int argc, char **argv)
     sparams.read_callback = file_read_cb;
     sparams.read_callback_user_data = &fctx;
     sparams.segment_callback = segment_cb;
-    sparams.segment_callback_user_data = NULL;
+    sparams.segment_callback_user_data = &jsonl;
     sparams.abort_callback = abort_cb;
     sparams.abort_callback_user_data = &abort_flag;
     sparams.slots[0].ctx = ctx0;
@@ -422,6 +519,13 @@ main(int argc, char **argv)
     sparams.slots[1].ctx = ctx1;
     sparams.slots[1].vad_ctx = vad_ctx1;
     sparams.slots[1].num_threads = n_threads;
+    struct whisper_stream_stats stats = {0};
+    sparams.stats = &stats;
+    if (metrics)
+    {
+        sparams.chunk_callback = metrics_chunk;
+        sparams.chunk_callback_user_data = metrics;
+    }
     if (live)
     {
         sparams.vad_threshold = 0.5;
@@ -436,8 +540,21 @@ main(int argc, char **argv)
     }
 
     ret = whisper_stream_full(wparams, sparams);
+    int64_t t_done = now_ms();
+    if (metrics)
+        metrics_finish(metrics, &stats, ret, atomic_load(&abort_flag));
+
+    print_mem_stats(&stats, stream_ctx);
+    if (ops_path && write_ops(&op_rec, ops_path) < 0)
+        ret = 1;
+    if (transfers)
+        print_transfers(&op_rec, &stats);
+    if (jsonl)
+        print_json_summary(&stats, stream_ctx, n_samples, t_decoded - t_start,
+                           t_loaded - t_decoded, t_done - t_loaded, ret);
 
 cleanup:
+    metrics_destroy(metrics);
     if (vad_ctx)
         whisper_vad_free(vad_ctx);
     if (vad_ctx1)
@@ -0,0 +1,434 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+
+/* Writes a tiny whisper model and a Silero VAD model with random weights,
+ * plus synthetic speech-like audio, so that the whole stream path can run
+ * end to end in CI without the real models. The transcripts are garbage,
+ * only the timings matter.
+ *
+ * The whisper model uses the real n_vocab, n_audio_ctx, n_text_ctx and
+ * n_mels, which whisper.cpp expects, with tiny layers. The Silero graph has
+ * fixed shapes, so the VAD model only has random weights. */
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define GGML_FILE_MAGIC 0x67676d6c
+
+#define GGML_TYPE_F32 0
+#define GGML_TYPE_F16 1
+
+#define SAMPLE_RATE 16000
+
+struct whisper_hparams
+{
+    int32_t n_vocab;
+    int32_t n_audio_ctx;
+    int32_t n_audio_state;
+    int32_t n_audio_head;
+    int32_t n_audio_layer;
+    int32_t n_text_ctx;
+    int32_t n_text_state;
+    int32_t n_text_head;
+    int32_t n_text_layer;
+    int32_t n_mels;
+    int32_t ftype;
+};
+
+/* Silero v5/v6 as written by whisper.cpp's converter */
+#define VAD_N_ENCODER_LAYERS 4
+static const int32_t vad_in_channels[VAD_N_ENCODER_LAYERS]  = { 129, 128, 64, 64 };
+static const int32_t vad_out_channels[VAD_N_ENCODER_LAYERS] = { 128, 64, 64, 128 };
+#define VAD_KERNEL_SIZE  3
+#define VAD_LSTM_SIZE    128
+#define VAD_STFT_BINS    258
+#define VAD_STFT_WINDOW  256
+
+static uint32_t g_rng = 42;
+
+static float
+rand_uniform(void)
+{
+    /* xorshift32, deterministic across libcs */
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (g_rng >> 8) / (float)(1 << 24);
+}
+
+static uint16_t
+fp32_to_fp16(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof x);
+
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exp = ((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = x & 0x7fffff;
+
+    if (exp <= 0)
+        return sign;
+    if (exp >= 31)
+        return sign | 0x7c00;
+    return sign | (exp << 10) | (mant >> 13);
+}
+
+static int
+write_i32(FILE *f, int32_t v)
+{
+    return fwrite(&v, sizeof v, 1, f) == 1 ? 0 : -1;
+}
+
+/* init: 'r' random in [-scale, scale], '1' ones, '0' zeros */
+static int
+write_tensor(FILE *f, const char *name, int type, int n_dims, const int32_t *ne,
+             char init, float scale)
+{
+    int64_t n = 1;
+    int32_t len = (int32_t)strlen(name);
+
+    write_i32(f, n_dims);
+    write_i32(f, len);
+    write_i32(f, type);
+    for (int i = 0; i < n_dims; i++)
+    {
+        write_i32(f, ne[i]);
+        n *= ne[i];
+    }
+    fwrite(name, 1, len, f);
+
+    for (int64_t i = 0; i < n; i++)
+    {
+        float v = init == 'r' ? (rand_uniform() * 2.0f - 1.0f) * scale
+                : init == '1' ? 1.0f : 0.0f;
+        if (type == GGML_TYPE_F16)
+        {
+            uint16_t h = fp32_to_fp16(v);
+            fwrite(&h, sizeof h, 1, f);
+        }
+        else
+        {
+            fwrite(&v, sizeof v, 1, f);
+        }
+    }
+    return ferror(f) ? -1 : 0;
+}
+
+#define TENSOR(f, name, type, init, scale, ...)                                  \
+    write_tensor(f, name, type, sizeof((int32_t[]){ __VA_ARGS__ }) / sizeof(int32_t), \
+                 (int32_t[]){ __VA_ARGS__ }, init, scale)
+
+static void
+write_layer_norm(FILE *f, const char *prefix, const char *ln, int n_state)
+{
+    char name[128];
+    snprintf(name, sizeof name, "%s.%s.weight", prefix, ln);
+    TENSOR(f, name, GGML_TYPE_F32, '1', 0, n_state);
+    snprintf(name, sizeof name, "%s.%s.bias", prefix, ln);
+    TENSOR(f, name, GGML_TYPE_F32, '0', 0, n_state);
+}
+
+static void
+write_attention(FILE *f, const char *prefix, const char *attn, int n_state)
+{
+    static const char *const parts[] = { "query", "key", "value", "out" };
+    char name[128];
+    float scale = 1.0f / sqrtf(n_state);
+
+    for (int i = 0; i < 4; i++)
+    {
+        snprintf(name, sizeof name, "%s.%s.%s.weight", prefix, attn, parts[i]);
+        TENSOR(f, name, GGML_TYPE_F32, 'r', scale, n_state, n_state);
+        if (i == 1)
+            continue;   /* key has no bias */
+        snprintf(name, sizeof name, "%s.%s.%s.bias", prefix, attn, parts[i]);
+        TENSOR(f, name, GGML_TYPE_F32, '0', 0, n_state);
+    }
+}
+
+static void
+write_block(FILE *f, const char *prefix, int n_state, int cross)
+{
+    char name[128];
+    float scale = 1.0f / sqrtf(n_state);
+
+    write_layer_norm(f, prefix, "attn_ln", n_state);
+    write_attention(f, prefix, "attn", n_state);
+    if (cross)
+    {
+        write_layer_norm(f, prefix, "cross_attn_ln", n_state);
+        write_attention(f, prefix, "cross_attn", n_state);
+    }
+
+    write_layer_norm(f, prefix, "mlp_ln", n_state);
+    snprintf(name, sizeof name, "%s.mlp.0.weight", prefix);
+    TENSOR(f, name, GGML_TYPE_F32, 'r', scale, n_state, 4 * n_state);
+    snprintf(name, sizeof name, "%s.mlp.0.bias", prefix);
+    TENSOR(f, name, GGML_TYPE_F32, '0', 0, 4 * n_state);
+    snprintf(name, sizeof name, "%s.mlp.2.weight", prefix);
+    TENSOR(f, name, GGML_TYPE_F32, 'r', scale / 2, 4 * n_state, n_state);
+    snprintf(name, sizeof name, "%s.mlp.2.bias", prefix);
+    TENSOR(f, name, GGML_TYPE_F32, '0', 0, n_state);
+}
+
+/* Layout of whisper_model_load(), all F32 (ftype 0) */
+static int
+write_whisper_model(const char *path, const struct whisper_hparams *hp)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    write_i32(f, GGML_FILE_MAGIC);
+    fwrite(hp, sizeof *hp, 1, f);
+
+    /* Triangular mel filters over the 201 FFT bins */
+    const int n_fft = 201;
+    write_i32(f, hp->n_mels);
+    write_i32(f, n_fft);
+    for (int m = 0; m < hp->n_mels; m++)
+    {
+        float center = (m + 1) * (float)(n_fft - 1) / (hp->n_mels + 1);
+        float width = (float)(n_fft - 1) / (hp->n_mels + 1);
+        for (int k = 0; k < n_fft; k++)
+        {
+            float v = 1.0f - fabsf(k - center) / width;
+            v = v > 0 ? v : 0;
+            fwrite(&v, sizeof v, 1, f);
+        }
+    }
+
+    /* Byte tokens, the loader names the rest up to n_vocab */
+    write_i32(f, 256);
+    for (int i = 0; i < 256; i++)
+    {
+        uint8_t c = (uint8_t)i;
+        write_i32(f, 1);
+        fwrite(&c, 1, 1, f);
+    }
+
+    int sa = hp->n_audio_state;
+    int st = hp->n_text_state;
+    char prefix[64];
+
+    TENSOR(f, "encoder.positional_embedding", GGML_TYPE_F32, 'r', 0.1f, sa, hp->n_audio_ctx);
+    TENSOR(f, "encoder.conv1.weight", GGML_TYPE_F32, 'r', 0.1f, 3, hp->n_mels, sa);
+    TENSOR(f, "encoder.conv1.bias", GGML_TYPE_F32, '0', 0, 1, sa);
+    TENSOR(f, "encoder.conv2.weight", GGML_TYPE_F32, 'r', 0.1f, 3, sa, sa);
+    TENSOR(f, "encoder.conv2.bias", GGML_TYPE_F32, '0', 0, 1, sa);
+    for (int i = 0; i < hp->n_audio_layer; i++)
+    {
+        snprintf(prefix, sizeof prefix, "encoder.blocks.%d", i);
+        write_block(f, prefix, sa, 0);
+    }
+    write_layer_norm(f, "encoder", "ln_post", sa);
+
+    TENSOR(f, "decoder.positional_embedding", GGML_TYPE_F32, 'r', 0.1f, st, hp->n_text_ctx);
+    TENSOR(f, "decoder.token_embedding.weight", GGML_TYPE_F32, 'r', 0.1f, st, hp->n_vocab);
+    for (int i = 0; i < hp->n_text_layer; i++)
+    {
+        snprintf(prefix, sizeof prefix, "decoder.blocks.%d", i);
+        write_block(f, prefix, st, 1);
+    }
+    write_layer_norm(f, "decoder", "ln", st);
+
+    int ret = ferror(f) ? -1 : 0;
+    if (fclose(f) != 0)
+        ret = -1;
+    return ret;
+}
+
+/* Layout of whisper_vad_init_with_params() */
+static int
+write_vad_model(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    static const char type[] = "silero-16k";
+    write_i32(f, GGML_FILE_MAGIC);
+    write_i32(f, (int32_t)strlen(type));
+    fwrite(type, 1, strlen(type), f);
+    write_i32(f, 6);
+    write_i32(f, 2);
+    write_i32(f, 0);
+
+    write_i32(f, VAD_N_ENCODER_LAYERS);
+    for (int i = 0; i < VAD_N_ENCODER_LAYERS; i++)
+    {
+        write_i32(f, vad_in_channels[i]);
+        write_i32(f, vad_out_channels[i]);
+        write_i32(f, VAD_KERNEL_SIZE);
+    }
+    write_i32(f, VAD_LSTM_SIZE);    /* lstm_input_size */
+    write_i32(f, VAD_LSTM_SIZE);    /* lstm_hidden_size */
+    write_i32(f, VAD_LSTM_SIZE);    /* final_conv_in */
+    write_i32(f, 1);                /* final_conv_out */
+
+    TENSOR(f, "_model.stft.forward_basis_buffer", GGML_TYPE_F16, 'r', 0.05f,
+           VAD_STFT_WINDOW, 1, VAD_STFT_BINS);
+    for (int i = 0; i < VAD_N_ENCODER_LAYERS; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof name, "_model.encoder.%d.reparam_conv.weight", i);
+        TENSOR(f, name, GGML_TYPE_F16, 'r', 0.1f,
+               VAD_KERNEL_SIZE, vad_in_channels[i], vad_out_channels[i]);
+        snprintf(name, sizeof name, "_model.encoder.%d.reparam_conv.bias", i);
+        TENSOR(f, name, GGML_TYPE_F32, '0', 0, vad_out_channels[i]);
+    }
+    TENSOR(f, "_model.decoder.rnn.weight_ih", GGML_TYPE_F32, 'r', 0.1f, VAD_LSTM_SIZE, 4 * VAD_LSTM_SIZE);
+    TENSOR(f, "_model.decoder.rnn.weight_hh", GGML_TYPE_F32, 'r', 0.1f, VAD_LSTM_SIZE, 4 * VAD_LSTM_SIZE);
+    TENSOR(f, "_model.decoder.rnn.bias_ih", GGML_TYPE_F32, '0', 0, 4 * VAD_LSTM_SIZE);
+    TENSOR(f, "_model.decoder.rnn.bias_hh", GGML_TYPE_F32, '0', 0, 4 * VAD_LSTM_SIZE);
+    TENSOR(f, "_model.decoder.decoder.2.weight", GGML_TYPE_F16, 'r', 0.1f, VAD_LSTM_SIZE, 1);
+    TENSOR(f, "_model.decoder.decoder.2.bias", GGML_TYPE_F32, '0', 0, 1);
+
+    int ret = ferror(f) ? -1 : 0;
+    if (fclose(f) != 0)
+        ret = -1;
+    return ret;
+}
+
+/* 16-bit mono WAV: noisy tone bursts separated by silence */
+static int
+write_audio(const char *path, int seconds, int speech_ms, int silence_ms)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        fprintf(stderr, "Failed to create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    int32_t n = seconds * SAMPLE_RATE;
+    int32_t data_size = n * 2;
+
+    fwrite("RIFF", 1, 4, f);
+    write_i32(f, 36 + data_size);
+    fwrite("WAVEfmt ", 1, 8, f);
+    write_i32(f, 16);
+    uint16_t fmt[2] = { 1, 1 };                 /* PCM, mono */
+    fwrite(fmt, sizeof fmt, 1, f);
+    write_i32(f, SAMPLE_RATE);
+    write_i32(f, SAMPLE_RATE * 2);
+    uint16_t align[2] = { 2, 16 };
+    fwrite(align, sizeof align, 1, f);
+    fwrite("data", 1, 4, f);
+    write_i32(f, data_size);
+
+    int period = (speech_ms + silence_ms) * SAMPLE_RATE / 1000;
+    int speech = speech_ms * SAMPLE_RATE / 1000;
+    for (int32_t i = 0; i < n; i++)
+    {
+        float v = 0;
+        if (period <= 0 || i % period < speech)
+        {
+            float t = (float)i / SAMPLE_RATE;
+            float pitch = 120.0f + 40.0f * sinf(2.0f * (float)M_PI * 0.7f * t);
+            v = 0.3f * sinf(2.0f * (float)M_PI * pitch * t)
+              + 0.05f * (rand_uniform() * 2.0f - 1.0f);
+        }
+        int16_t s = (int16_t)(v * 32767.0f);
+        fwrite(&s, sizeof s, 1, f);
+    }
+
+    int ret = ferror(f) ? -1 : 0;
+    if (fclose(f) != 0)
+        ret = -1;
+    return ret;
+}
+
+static void
+usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  -o, --out DIR         Output directory (default: .)\n");
+    fprintf(stderr, "  -n, --state N         Encoder and decoder width (default: 16)\n");
+    fprintf(stderr, "  -l, --layers N        Encoder and decoder layers (default: 1)\n");
+    fprintf(stderr, "  -a, --audio S         Synthetic audio length in seconds (default: 60)\n");
+    fprintf(stderr, "Writes ggml-tiny-synth.bin, ggml-silero-synth.bin and synth.wav\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *out_dir = ".";
+    int n_state = 16;
+    int n_layers = 1;
+    int audio_s = 60;
+
+    static struct option long_opts[] = {
+        {"out",    required_argument, 0, 'o'},
+        {"state",  required_argument, 0, 'n'},
+        {"layers", required_argument, 0, 'l'},
+        {"audio",  required_argument, 0, 'a'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:n:l:a:", long_opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'o': out_dir = optarg; break;
+        case 'n': n_state = atoi(optarg); break;
+        case 'l': n_layers = atoi(optarg); break;
+        case 'a': audio_s = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Two text layers would be taken for a distil model */
+    if (n_state < 4 || n_state % 4 || n_layers < 1 || n_layers == 2 || audio_s < 1)
+    {
+        fprintf(stderr, "state must be a multiple of 4, layers >= 1 and not 2\n");
+        return 1;
+    }
+
+    if (mkdir(out_dir, 0755) < 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Failed to create %s: %s\n", out_dir, strerror(errno));
+        return 1;
+    }
+
+    struct whisper_hparams hp = {
+        .n_vocab = 51865,           /* multilingual */
+        .n_audio_ctx = 1500,
+        .n_audio_state = n_state,
+        .n_audio_head = 1,
+        .n_audio_layer = n_layers,
+        .n_text_ctx = 448,
+        .n_text_state = n_state,
+        .n_text_head = 1,
+        .n_text_layer = n_layers,
+        .n_mels = 80,
+        .ftype = 0,
+    };
+
+    char path[4096];
+    snprintf(path, sizeof path, "%s/ggml-tiny-synth.bin", out_dir);
+    if (write_whisper_model(path, &hp) < 0)
+        return 1;
+    snprintf(path, sizeof path, "%s/ggml-silero-synth.bin", out_dir);
+    if (write_vad_model(path) < 0)
+        return 1;
+    snprintf(path, sizeof path, "%s/synth.wav", out_dir);
+    if (write_audio(path, audio_s, 4000, 600) < 0)
+        return 1;
+
+    return 0;
+}